@@ -12,77 +12,608 @@
 #include <set>
 #include <numeric>
 #include <limits> //i don't have bits/stdc++.h on MacOs
+#include <string_view>
+#include <cstdint>
+#include "../../FastIO/fast_io.h"
 
 using namespace std;
 
+// Every patient lives exactly once, in a slab (vector) at a dense id.
+// The name is NOT copied here, it points at the key inside patient_ids.
 class Patient {
     public:
+        const string* name;
         int severity;
         int arrival;
-        string name;
+};
+
+/*  Priority as ONE 64-bit number, so comparing two patients is a single
+    integer compare instead of operator< on two ints:
+
+        [ 32 bits: severity, flipped | 32 bits: arrival ]
+
+    Flipping makes higher severity -> smaller key (comes first in the map).
+    XOR with 0x80000000 first turns the signed int into an unsigned number
+    with the same order, so negative severities work too.
+    Arrivals are unique, so two patients never get the same key.
+*/
+static uint64_t priority_key(int severity, int arrival) {
+    uint32_t sev = ~((uint32_t)severity ^ 0x80000000u);
+    return ((uint64_t)sev << 32) | (uint32_t)arrival;
+}
+
+/*  Bucket queue - used while every severity is a small integer in [0, BUCKETS)
+
+    Instead of a tree we keep one bucket per severity value, holding the
+    ids of the patients with that severity.
+
+    To find the highest non-empty severity we keep a bitmap: bit s is set
+    when bucket s is non-empty. One more 64-bit word ("summary") says which
+    bitmap words are non-empty, so the top bucket is two count-leading-zeros:
 
-    Patient() = default; //for unordered_map
+        word = 63 - clz(summary),  bit = 63 - clz(bits[word])
 
-    Patient(string name, int severity, int arrival)
-    : name(move(name)), severity(severity), arrival(arrival) {}
+    Inside a bucket the patients must come out by arrival. New patients
+    always have the latest arrival, but a bumped patient lands in the
+    middle of their new bucket, so a plain FIFO list would have to be
+    walked. Each bucket is a small min-heap on arrival instead:
 
-    bool operator<(const Patient& other) const {
-        if (severity != other.severity) {
-            return severity > other.severity; // higher severity first
+    insert of a new arrival = push, sift-up stops at once, O(1)
+    remove / increase       = O(log bucket size)
+    top                     = two clz + heap[0], O(1)
+*/
+class SeverityBuckets {
+    public:
+        static const int BUCKETS = 4096; // = 64 words of 64 bits
+
+        static bool fits(int severity) { return severity >= 0 && severity < BUCKETS; }
+
+        explicit SeverityBuckets(const vector<Patient>& slab) : slab(slab), heaps(BUCKETS) {}
+
+        bool empty() const { return summary == 0; }
+
+        uint32_t top() const {
+            int word = 63 - __builtin_clzll(summary);
+            int bit = 63 - __builtin_clzll(bits[word]);
+            return heaps[word * 64 + bit][0];
+        }
+
+        void insert(uint32_t id) {
+            if (id >= position.size())
+                position.resize(id + 1);
+            int s = slab[id].severity;
+            heaps[s].push_back(id);
+            siftUp(heaps[s], heaps[s].size() - 1);
+
+            bits[s >> 6] |= 1ULL << (s & 63);
+            summary |= 1ULL << (s >> 6);
+        }
+
+        void remove(uint32_t id) {
+            int s = slab[id].severity;
+            vector<uint32_t>& heap = heaps[s];
+            size_t i = position[id];
+            uint32_t last = heap.back();
+            heap.pop_back();
+
+            if (last != id) { // last one fills the hole and moves whichever way it has to
+                place(heap, i, last);
+                siftUp(heap, i);
+                siftDown(heap, position[last]);
+            }
+
+            if (heap.empty()) {
+                bits[s >> 6] &= ~(1ULL << (s & 63));
+                if (bits[s >> 6] == 0)
+                    summary &= ~(1ULL << (s >> 6));
+            }
+        }
+
+        // the next k ids in queue order, nothing removed. A bucket's heap is
+        // only heap ordered, so it is walked best first: take the earliest
+        // candidate, its two children become candidates. O(k log k)
+        template <class F>
+        void forEachTop(size_t k, F f) const {
+            typedef pair<int, size_t> Candidate; // arrival, index in the heap
+            for (uint64_t words = summary; words && k; ) {
+                int w = 63 - __builtin_clzll(words);
+                words &= ~(1ULL << w);
+                for (uint64_t b = bits[w]; b && k; ) {
+                    int bit = 63 - __builtin_clzll(b);
+                    b &= ~(1ULL << bit);
+                    const vector<uint32_t>& heap = heaps[w * 64 + bit];
+
+                    priority_queue<Candidate, vector<Candidate>, greater<Candidate>> candidates;
+                    candidates.push({slab[heap[0]].arrival, 0});
+                    while (!candidates.empty() && k) {
+                        size_t i = candidates.top().second;
+                        candidates.pop();
+                        f(heap[i]);
+                        k--;
+                        for (size_t c = 2 * i + 1; c <= 2 * i + 2 && c < heap.size(); c++)
+                            candidates.push({slab[heap[c]].arrival, c});
+                    }
+                }
+            }
+        }
+
+        // every id, in no particular order (used when we switch to the tree)
+        template <class F>
+        void forEach(F f) const {
+            for (const vector<uint32_t>& heap : heaps)
+                for (uint32_t id : heap)
+                    f(id);
+        }
+
+    private:
+        const vector<Patient>& slab;
+        vector<vector<uint32_t>> heaps;
+        vector<uint32_t> position; // id -> index in its bucket's heap
+        uint64_t bits[BUCKETS / 64] = {};
+        uint64_t summary = 0;
+
+        bool earlier(uint32_t a, uint32_t b) const { return slab[a].arrival < slab[b].arrival; }
+
+        void place(vector<uint32_t>& heap, size_t i, uint32_t id) {
+            heap[i] = id;
+            position[id] = i;
+        }
+
+        void siftUp(vector<uint32_t>& heap, size_t i) {
+            uint32_t id = heap[i];
+            while (i > 0 && earlier(id, heap[(i - 1) / 2])) {
+                place(heap, i, heap[(i - 1) / 2]);
+                i = (i - 1) / 2;
+            }
+            place(heap, i, id);
+        }
+
+        void siftDown(vector<uint32_t>& heap, size_t i) {
+            uint32_t id = heap[i];
+            while (2 * i + 1 < heap.size()) {
+                size_t child = 2 * i + 1;
+                if (child + 1 < heap.size() && earlier(heap[child + 1], heap[child]))
+                    child++;
+                if (!earlier(heap[child], id)) break;
+                place(heap, i, heap[child]);
+                i = child;
+            }
+            place(heap, i, id);
         }
-        return arrival < other.arrival; // earlier arrival first
-    }
 };
 
-int main() {
-    ios::sync_with_stdio( false );
-    cin.tie( nullptr ); //these two lines are for SPEED :)
+/*  Pairing heap - the --backend pairing queue (any int severity)
+
+    A heap ordered tree with any number of children per node: every
+    patient comes before all of their children, so the root is next.
+    The links live in arrays next to the slab (child, next sibling, prev =
+    parent for a first child, the left sibling otherwise), so a patient's
+    id is its node handle and admits never allocate.
+
+    meld(a, b): the later of the two roots becomes the first child of the
+    earlier one. Everything else is built from it:
+
+    insert          = meld(root, id)                              O(1)
+    moveUp (a bump) = cut id's subtree out, meld(root, id)        O(1) amortized
+    remove          = cut id out, pair up its children, meld back O(log n) amortized
+    top             = root                                        O(1)
+
+    A bump only makes a patient MORE urgent, so the cut subtree is still
+    heap ordered. Children are combined two-pass (meld in pairs left to
+    right, then the pairs right to left), which is what keeps the bounds.
+    Same thing as pairing_heap.cpp in C_Implementation, with ids for pointers.
+*/
+class PairingHeap {
+    public:
+        explicit PairingHeap(const vector<Patient>& slab) : slab(slab) {}
+
+        bool empty() const { return root == NONE; }
+
+        uint32_t top() const { return root; }
+
+        void insert(uint32_t id) {
+            if (id >= child.size()) {
+                child.resize(id + 1);
+                next.resize(id + 1);
+                prev.resize(id + 1);
+            }
+            child[id] = next[id] = prev[id] = NONE;
+            root = meld(root, id);
+        }
+
+        void remove(uint32_t id) {
+            if (id != root) {
+                cut(id);
+                root = meld(root, combine(child[id]));
+            } else {
+                root = combine(child[id]);
+            }
+        }
+
+        // id's severity went up: its subtree is still in order, cut it and meld with the root
+        void moveUp(uint32_t id) {
+            if (id == root)
+                return;
+            cut(id);
+            root = meld(root, id);
+        }
+
+        // the next k ids in queue order, nothing removed: best first over
+        // the tree, a node's children become candidates once it is printed.
+        // After a run of admits the root has one child per admit, so each
+        // printed node first gets its children paired up (what a remove
+        // does, O(log n) amortized) and hands on just one: O(k log n)
+        template <class F>
+        void forEachTop(size_t k, F f) {
+            typedef pair<uint64_t, uint32_t> Candidate; // priority_key, id
+            priority_queue<Candidate, vector<Candidate>, greater<Candidate>> candidates;
+            if (root != NONE)
+                candidates.push({key(root), root});
+            while (!candidates.empty() && k) {
+                uint32_t id = candidates.top().second;
+                candidates.pop();
+                f(id);
+                k--;
+                if (child[id] != NONE && next[child[id]] != NONE) {
+                    child[id] = combine(child[id]);
+                    prev[child[id]] = id;
+                }
+                if (child[id] != NONE)
+                    candidates.push({key(child[id]), child[id]});
+            }
+        }
 
-    set<Patient> patients;
-    unordered_map<string, Patient> patient_dictionary;
+    private:
+        static const uint32_t NONE = UINT32_MAX;
+
+        const vector<Patient>& slab;
+        vector<uint32_t> child, next, prev; // id -> id, NONE if there is none
+        vector<uint32_t> pairs;             // scratch for combine()
+        uint32_t root = NONE;
+
+        uint64_t key(uint32_t id) const { return priority_key(slab[id].severity, slab[id].arrival); }
+
+        // a and b are roots (no prev, no sibling)
+        uint32_t meld(uint32_t a, uint32_t b) {
+            if (a == NONE) return b;
+            if (b == NONE) return a;
+            if (key(b) < key(a))
+                swap(a, b);
+            prev[b] = a;
+            next[b] = child[a];
+            if (child[a] != NONE)
+                prev[child[a]] = b;
+            child[a] = b;
+            return a;
+        }
+
+        // takes id (with its subtree) out of its sibling list
+        void cut(uint32_t id) {
+            if (child[prev[id]] == id)
+                child[prev[id]] = next[id];
+            else
+                next[prev[id]] = next[id];
+            if (next[id] != NONE)
+                prev[next[id]] = prev[id];
+            prev[id] = next[id] = NONE;
+        }
+
+        // two-pass pairing of the sibling list starting at first, returns one root
+        uint32_t combine(uint32_t first) {
+            pairs.clear();
+            while (first != NONE) {
+                uint32_t a = first, b = next[a];
+                first = b != NONE ? next[b] : NONE;
+                prev[a] = next[a] = NONE;
+                if (b != NONE)
+                    prev[b] = next[b] = NONE;
+                pairs.push_back(meld(a, b));
+            }
+            uint32_t result = NONE;
+            for (size_t i = pairs.size(); i-- > 0; )
+                result = meld(pairs[i], result);
+            return result;
+        }
+};
+
+/*  Rank index - command 5 in O(log n) for every backend
+
+    None of the queues can count the patients ahead of someone cheaply:
+    std::map keeps no subtree sizes, and the bucket and pairing heaps only
+    know heap order. So from the first position query on, every waiting
+    patient is also in this treap: a search tree on priority_key whose
+    nodes carry a random priority (heap ordered, which keeps the tree
+    balanced in expectation) and the size of their subtree.
+
+    insert / remove = split at the key, merge back    O(log n) expected
+    countLess(key)  = one path down, adding up the left subtrees passed
+
+    Arrays by id again, like the pairing heap. A patient has to come out
+    BEFORE their key changes and go back in after.
+*/
+class RankIndex {
+    public:
+        explicit RankIndex(const vector<Patient>& slab) : slab(slab) {}
+
+        void insert(uint32_t id) {
+            if (id >= left.size()) {
+                left.resize(id + 1);
+                right.resize(id + 1);
+                size.resize(id + 1);
+                prio.resize(id + 1);
+            }
+            left[id] = right[id] = NONE;
+            size[id] = 1;
+            prio[id] = random();
+            uint32_t less, rest;
+            split(root, key(id), less, rest);
+            root = merge(merge(less, id), rest);
+        }
+
+        void remove(uint32_t id) {
+            uint32_t less, rest, self;
+            split(root, key(id), less, rest);
+            split(rest, key(id) + 1, self, rest); // keys are unique: self is id alone
+            root = merge(less, rest);
+        }
+
+        // waiting patients whose key is smaller
+        size_t countLess(uint64_t k) const {
+            size_t count = 0;
+            for (uint32_t t = root; t != NONE; ) {
+                if (key(t) < k) {
+                    count += sizeOf(left[t]) + 1;
+                    t = right[t];
+                } else {
+                    t = left[t];
+                }
+            }
+            return count;
+        }
+
+    private:
+        static const uint32_t NONE = UINT32_MAX;
+
+        const vector<Patient>& slab;
+        vector<uint32_t> left, right, size, prio; // id -> ..., NONE if there is none
+        uint32_t root = NONE;
+        uint32_t seed = 2463534242u;
+
+        uint64_t key(uint32_t id) const { return priority_key(slab[id].severity, slab[id].arrival); }
+        uint32_t sizeOf(uint32_t t) const { return t == NONE ? 0 : size[t]; }
+
+        uint32_t random() { // xorshift32
+            seed ^= seed << 13;
+            seed ^= seed >> 17;
+            seed ^= seed << 5;
+            return seed;
+        }
+
+        // t's keys < k go to less, the others to rest
+        void split(uint32_t t, uint64_t k, uint32_t& less, uint32_t& rest) {
+            if (t == NONE) {
+                less = rest = NONE;
+                return;
+            }
+            if (key(t) < k) {
+                split(right[t], k, right[t], rest);
+                less = t;
+            } else {
+                split(left[t], k, less, left[t]);
+                rest = t;
+            }
+            size[t] = sizeOf(left[t]) + sizeOf(right[t]) + 1;
+        }
+
+        // every key in a is smaller than every key in b
+        uint32_t merge(uint32_t a, uint32_t b) {
+            if (a == NONE) return b;
+            if (b == NONE) return a;
+            if (prio[a] > prio[b]) {
+                right[a] = merge(right[a], b);
+                size[a] = sizeOf(left[a]) + sizeOf(right[a]) + 1;
+                return a;
+            }
+            left[b] = merge(a, left[b]);
+            size[b] = sizeOf(left[b]) + sizeOf(right[b]) + 1;
+            return b;
+        }
+};
+
+// lets unordered_map<string, ...>::find take a string_view without building a string
+struct NameHash {
+    using is_transparent = void;
+    size_t operator()(string_view name) const { return hash<string_view>{}(name); }
+};
+
+// ./C++_Code [--backend buckets|map|pairing], same output for all three:
+//   buckets  bucket queue while severities are in [0, BUCKETS), then the map (default)
+//   map      the map from the start
+//   pairing  pairing heap, cheapest admits and bumps
+enum Backend { BUCKETS, MAP, PAIRING };
+
+static bool parseBackend(int argc, char** argv, Backend& backend) {
+    backend = BUCKETS;
+    for ( int i = 1; i < argc; i++ ) {
+        if ( string_view(argv[i]) != "--backend" )
+            continue;
+        string_view name = i + 1 < argc ? argv[i + 1] : "";
+        if ( name == "buckets" ) backend = BUCKETS;
+        else if ( name == "map" ) backend = MAP;
+        else if ( name == "pairing" ) backend = PAIRING;
+        else return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    Backend backend;
+    if ( !parseBackend(argc, argv, backend) ) {
+        cerr << "usage: " << argv[0] << " [--backend buckets|map|pairing]\n";
+        return 1;
+    }
+
+    FastReader in; // reads all of stdin at once, names are views into it
+    FastWriter out; //these two are for SPEED :)
+
+    vector<Patient> slab;     // id -> patient
+    vector<uint32_t> free_ids; // ids of discharged patients, reused first
+    map<uint64_t, uint32_t> queue; // priority_key -> id, begin() is the next patient
+
+    // Small severities: bucket queue. The first severity outside [0, BUCKETS)
+    // moves everyone into the map and we stay with the map from then on.
+    SeverityBuckets buckets(slab);
+    PairingHeap heap(slab);
+    bool use_buckets = backend == BUCKETS;
+    bool use_heap = backend == PAIRING;
+    RankIndex ranks(slab);   // built on the first position query (command 5)
+    bool use_ranks = false;
+    auto switch_to_tree = [&]() {
+        buckets.forEach([&](uint32_t id) {
+            queue.emplace(priority_key(slab[id].severity, slab[id].arrival), id);
+        });
+        use_buckets = false;
+    };
+    // the three queues behind one set of calls (and the rank index, once there is one)
+    auto queue_insert = [&](uint32_t id) {
+        if ( use_buckets ) buckets.insert(id);
+        else if ( use_heap ) heap.insert(id);
+        else queue.emplace(priority_key(slab[id].severity, slab[id].arrival), id);
+        if ( use_ranks ) ranks.insert(id);
+    };
+    auto queue_remove = [&](uint32_t id) {
+        if ( use_buckets ) buckets.remove(id);
+        else if ( use_heap ) heap.remove(id);
+        else queue.erase(priority_key(slab[id].severity, slab[id].arrival));
+        if ( use_ranks ) ranks.remove(id);
+    };
+    auto queue_empty = [&]() {
+        return use_buckets ? buckets.empty() : use_heap ? heap.empty() : queue.empty();
+    };
+    unordered_map<string, uint32_t, NameHash, equal_to<>> patient_ids; // name -> id, owns the name
     int t, arrival = 0;
 
-    cin >> t;
+    t = in.readInt();
 
     while ( t-- ) {
-        int command;
-        cin >> command;
-        string patient_name;
+        int command = in.readInt();
+        string_view patient_name;
 
         if ( command == 0 ) {
-            int severity;
-            cin >> patient_name >> severity;
-            Patient p(patient_name, severity, arrival++);
-            patients.insert(p);
-            patient_dictionary[patient_name] = p;
+            patient_name = in.readToken();
+            int severity = in.readInt();
+
+            // the only copy of the name: the key of patient_ids.
+            // A name that is already waiting keeps its slot and is queued
+            // again with the new severity, as if it had just arrived
+            auto entry = patient_ids.find(patient_name);
+            uint32_t id;
+            if ( entry != patient_ids.end() ) {
+                id = entry->second;
+                queue_remove(id);
+            } else {
+                if ( !free_ids.empty() ) {
+                    id = free_ids.back();
+                    free_ids.pop_back();
+                } else {
+                    id = slab.size();
+                    slab.emplace_back();
+                }
+                entry = patient_ids.emplace(string(patient_name), id).first;
+            }
+            slab[id] = Patient{&entry->first, severity, arrival};
+            arrival++;
+
+            if ( use_buckets && !SeverityBuckets::fits(severity) )
+                switch_to_tree();
+            queue_insert(id);
         }
         else if ( command == 1 ) {
-            int increase;
-            cin >> patient_name >> increase;
-            auto it = patient_dictionary.find(patient_name);
-            if ( it != patient_dictionary.end() ) {
-                patients.erase(it->second);
-                it->second.severity += increase;
-                patients.insert(it->second);
+            patient_name = in.readToken();
+            int increase = in.readInt();
+            auto it = patient_ids.find(patient_name);
+            if ( it != patient_ids.end() ) {
+                Patient& p = slab[it->second];
+                if ( use_buckets && !SeverityBuckets::fits(p.severity + increase) )
+                    switch_to_tree();
+
+                if ( use_buckets || (use_heap && increase < 0) ) {
+                    queue_remove(it->second);
+                    p.severity += increase;
+                    queue_insert(it->second);
+                } else {
+                    if ( use_ranks ) ranks.remove(it->second);
+                    if ( use_heap ) {
+                        p.severity += increase; // only more urgent: the heap just moves the subtree up
+                        heap.moveUp(it->second);
+                    } else {
+                        // re-key the existing map node instead of erase + allocate
+                        auto node = queue.extract(priority_key(p.severity, p.arrival));
+                        p.severity += increase;
+                        node.key() = priority_key(p.severity, p.arrival);
+                        queue.insert(move(node));
+                    }
+                    if ( use_ranks ) ranks.insert(it->second);
+                }
             }
         }
         else if ( command == 2 ) {
-                cin >> patient_name;
-                auto it = patient_dictionary.find(patient_name);
-                if ( it != patient_dictionary.end() ) {
-                    patients.erase(it->second);
-                    patient_dictionary.erase(it);
+                patient_name = in.readToken();
+                auto it = patient_ids.find(patient_name);
+                if ( it != patient_ids.end() ) {
+                    queue_remove(it->second);
+                    free_ids.push_back(it->second);
+                    patient_ids.erase(it);
             }
         }
         else if ( command == 3 ) {
-            if ( patients.empty() ) {
-                cout << "The clinic is empty\n";
+            if ( queue_empty() ) {
+                out.write("The clinic is empty\n");
             }
             else {
-                const Patient& next_patient = *patients.begin();
-                cout << next_patient.name << "\n";
+                uint32_t next_id = use_buckets ? buckets.top() : use_heap ? heap.top() : queue.begin()->second;
+                const Patient& next_patient = slab[next_id];
+                out.write(*next_patient.name);
+                out.put('\n');
+            }
+        }
+        // not in the Kattis problem: 4 K = the next K patients, nobody removed
+        else if ( command == 4 ) {
+            int k = in.readInt();
+            if ( k > 0 && queue_empty() ) {
+                out.write("The clinic is empty\n");
+            }
+            else if ( k > 0 ) {
+                auto print = [&](uint32_t id) {
+                    out.write(*slab[id].name);
+                    out.put('\n');
+                };
+                if ( use_buckets )
+                    buckets.forEachTop(k, print);
+                else if ( use_heap )
+                    heap.forEachTop(k, print);
+                else
+                    for ( auto it = queue.begin(); it != queue.end() && k > 0; ++it, --k )
+                        print(it->second);
+            }
+        }
+        // 5 NAME = NAME's place in line (1 = next), 0 if not waiting
+        else if ( command == 5 ) {
+            patient_name = in.readToken();
+            auto it = patient_ids.find(patient_name);
+            size_t position = 0;
+            if ( it != patient_ids.end() ) {
+                if ( !use_ranks ) { // patient_ids holds exactly the waiting patients
+                    for ( const auto& [name, id] : patient_ids )
+                        ranks.insert(id);
+                    use_ranks = true;
+                }
+                const Patient& p = slab[it->second];
+                position = ranks.countLess(priority_key(p.severity, p.arrival)) + 1;
             }
+            out.writeInt(position);
+            out.put('\n');
         }
     }
     return 0;
-}
\ No newline at end of file
+}
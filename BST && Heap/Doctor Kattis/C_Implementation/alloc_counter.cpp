@@ -0,0 +1,80 @@
+// Allocation counter for triage_bench (Linux / glibc only)
+//
+//   ALLOC_COUNTER_OUT=stats.txt LD_PRELOAD=./liballoc_counter.so ./program
+//
+// Wraps malloc / calloc / realloc / aligned allocations (operator new ends up
+// in malloc too) and counts calls and requested bytes. At exit it writes
+// "<allocations> <bytes>" to the file named by ALLOC_COUNTER_OUT.
+// The real work is done by glibc's __libc_* functions, which doesn't need
+// dlsym - dlsym itself allocates, which would call us again.
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t n, size_t size);
+void* __libc_realloc(void* p, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+}
+
+static std::atomic<unsigned long long> allocations{0};
+static std::atomic<unsigned long long> bytes{0};
+
+static inline void count(size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    bytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+extern "C" {
+
+void* malloc(size_t size) {
+    count(size);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t n, size_t size) {
+    count(n * size);
+    return __libc_calloc(n, size);
+}
+
+void* realloc(void* p, size_t size) {
+    count(size);
+    return __libc_realloc(p, size);
+}
+
+void* aligned_alloc(size_t alignment, size_t size) {
+    count(size);
+    return __libc_memalign(alignment, size);
+}
+
+void* memalign(size_t alignment, size_t size) {
+    count(size);
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** out, size_t alignment, size_t size) {
+    count(size);
+    void* p = __libc_memalign(alignment, size);
+    if (!p)
+        return ENOMEM;
+    *out = p;
+    return 0;
+}
+
+}
+
+__attribute__((destructor)) static void write_counts() {
+    const char* path = getenv("ALLOC_COUNTER_OUT");
+    if (!path)
+        return;
+    unsigned long long a = allocations.load(), b = bytes.load();
+    FILE* f = fopen(path, "w");  // fopen allocates too, so the numbers are taken first
+    if (f) {
+        fprintf(f, "%llu %llu\n", a, b);
+        fclose(f);
+    }
+}
@@ -0,0 +1,177 @@
+/* =====================================================================
+ * BUCKET QUEUE (bounded integer priority queue)
+ * =====================================================================
+ *
+ * A red-black tree orders patients by comparing them, O(log n) per
+ * operation. But severities are small integers, so we can do better:
+ * one bucket per severity value.
+ *
+ *   bucket[100]: Alice(arrival 3), Carol(arrival 7)
+ *   bucket[ 99]: (empty)
+ *   bucket[ 98]: Bob(arrival 1)
+ *
+ * FINDING THE HIGHEST NON-EMPTY BUCKET - BITMAP + CLZ:
+ * bits[] has one bit per bucket (1 = non-empty), summary has one bit per
+ * word of bits[] (1 = that word is non-zero). clz ("count leading zeros")
+ * is a single CPU instruction, so:
+ *
+ *   word = 63 - clz(summary)      <- highest non-empty group of 64 buckets
+ *   bit  = 63 - clz(bits[word])   <- highest non-empty bucket in the group
+ *
+ * INSIDE A BUCKET - WHY NOT A PLAIN FIFO LIST?
+ * New patients always have the latest arrival, so for them "append at the
+ * tail" keeps the bucket sorted. A bumped patient is different: they
+ * arrived earlier than most of their new bucket, and finding their spot
+ * in a list means walking it - with 10^5 patients per bucket that is
+ * far slower than the tree. So each bucket is a small binary min-heap on
+ * arrival (same idea as the Powers of Two heap, just smallest on top):
+ *
+ *   new arrival  - O(1), it is the largest arrival, sift-up stops at once
+ *   bump/remove  - O(log bucket size)
+ *   top          - O(1), two clz + bucket.nodes[0]
+ *
+ * Only severities in [0, BUCKET_QUEUE_SIZE) fit - the caller has to check
+ * bucket_queue_fits() and use the tree otherwise.
+ * ===================================================================== */
+
+#include "bucket_queue.h"
+#include <stdlib.h>
+#include <queue>
+#include <utility>
+#include <vector>
+
+BucketQueue* bucket_queue_create() {
+    return (BucketQueue*)calloc(1, sizeof(BucketQueue));
+}
+
+int bucket_queue_fits(int severity) {
+    return severity >= 0 && severity < BUCKET_QUEUE_SIZE;
+}
+
+static void mark_non_empty(BucketQueue* q, int s) {
+    q->bits[s >> 6] |= 1ULL << (s & 63);
+    q->summary |= 1ULL << (s >> 6);
+}
+
+static void mark_empty(BucketQueue* q, int s) {
+    q->bits[s >> 6] &= ~(1ULL << (s & 63));
+    if (q->bits[s >> 6] == 0)
+        q->summary &= ~(1ULL << (s >> 6));
+}
+
+// Puts node at position i and remembers the position inside the node
+static void place(Bucket* b, int i, BucketNode* node) {
+    b->nodes[i] = node;
+    node->index = i;
+}
+
+static void sift_up(Bucket* b, int i) {
+    BucketNode* node = b->nodes[i];
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (b->nodes[parent]->arrival < node->arrival) break;
+        place(b, i, b->nodes[parent]);
+        i = parent;
+    }
+    place(b, i, node);
+}
+
+static void sift_down(Bucket* b, int i) {
+    BucketNode* node = b->nodes[i];
+    while (1) {
+        int child = 2 * i + 1;
+        if (child >= b->size) break;
+        if (child + 1 < b->size && b->nodes[child + 1]->arrival < b->nodes[child]->arrival)
+            child++;
+        if (node->arrival < b->nodes[child]->arrival) break;
+        place(b, i, b->nodes[child]);
+        i = child;
+    }
+    place(b, i, node);
+}
+
+void bucket_queue_insert(BucketQueue* q, BucketNode* node) {
+    Bucket* b = &q->buckets[node->severity];
+    if (b->size == b->capacity) {
+        b->capacity = b->capacity ? b->capacity * 2 : 8;
+        b->nodes = (BucketNode**)realloc(b->nodes, b->capacity * sizeof(BucketNode*));
+    }
+
+    place(b, b->size++, node);
+    sift_up(b, node->index);
+    mark_non_empty(q, node->severity);
+}
+
+void bucket_queue_remove(BucketQueue* q, BucketNode* node) {
+    Bucket* b = &q->buckets[node->severity];
+    int i = node->index;
+    BucketNode* last = b->nodes[--b->size];
+
+    if (last != node) {
+        // the last node fills the hole, then moves whichever way it has to
+        place(b, i, last);
+        sift_up(b, i);
+        sift_down(b, last->index);
+    }
+
+    if (b->size == 0)
+        mark_empty(q, node->severity);
+}
+
+BucketNode* bucket_queue_top(BucketQueue* q) {
+    if (!q->summary)
+        return NULL;
+    int word = 63 - __builtin_clzll(q->summary);
+    int bit = 63 - __builtin_clzll(q->bits[word]);
+    return q->buckets[word * 64 + bit].nodes[0];
+}
+
+int bucket_queue_empty(BucketQueue* q) {
+    return q->summary == 0;
+}
+
+/* =====================================================================
+ * LOOKING WITHOUT REMOVING: top k
+ * =====================================================================
+ * Non-empty buckets are visited from the highest severity down, straight
+ * from the bitmap (copy a word, take its top bit, clear it, repeat).
+ *
+ * A bucket's heap array is NOT sorted, only heap ordered: every node
+ * arrived before its two children. So a bucket is walked best first:
+ * keep a few candidates in a small heap, start with the root; the
+ * earliest candidate is the next patient, and its children become
+ * candidates. k patients = O(k log k), no matter how big the bucket is.
+ *
+ * Counting the patients ahead of someone can't be done fast from heap
+ * order alone; triage.cpp keeps a rank index for that.
+ * ===================================================================== */
+void bucket_queue_top_k(BucketQueue* q, int k, void (*fn)(BucketNode* node, void* ctx), void* ctx) {
+    typedef std::pair<int, int> Candidate; // arrival, index in the heap array
+
+    for (unsigned long long words = q->summary; words && k > 0; ) {
+        int w = 63 - __builtin_clzll(words);
+        words &= ~(1ULL << w);
+        for (unsigned long long bits = q->bits[w]; bits && k > 0; ) {
+            int bit = 63 - __builtin_clzll(bits);
+            bits &= ~(1ULL << bit);
+            Bucket* b = &q->buckets[w * 64 + bit];
+
+            std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> candidates;
+            candidates.push({b->nodes[0]->arrival, 0});
+            while (!candidates.empty() && k > 0) {
+                int i = candidates.top().second;
+                candidates.pop();
+                fn(b->nodes[i], ctx);
+                k--;
+                for (int c = 2 * i + 1; c <= 2 * i + 2 && c < b->size; c++)
+                    candidates.push({b->nodes[c]->arrival, c});
+            }
+        }
+    }
+}
+
+void bucket_queue_free(BucketQueue* q) {
+    for (int s = 0; s < BUCKET_QUEUE_SIZE; ++s)
+        free(q->buckets[s].nodes);  // the nodes themselves belong to the patients
+    free(q);
+}
@@ -0,0 +1,54 @@
+#ifndef C_IMPLEMENTATION_BUCKET_QUEUE_H
+#define C_IMPLEMENTATION_BUCKET_QUEUE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BUCKET_QUEUE_SIZE 4096 // severities 0 .. 4095, = 64 bitmap words
+
+    typedef struct Patient Patient; // forward declaration
+
+    // Lives inside the Patient: the queue only stores pointers to it
+    typedef struct BucketNode {
+        Patient* data;
+        int severity; // which bucket
+        int arrival;  // order inside the bucket
+        int index;    // position in that bucket's heap array
+    } BucketNode;
+
+    // Min-heap of the patients of one severity, ordered by arrival
+    typedef struct {
+        BucketNode** nodes;
+        int size;
+        int capacity;
+    } Bucket;
+
+    typedef struct BucketQueue {
+        Bucket buckets[BUCKET_QUEUE_SIZE];
+        unsigned long long bits[BUCKET_QUEUE_SIZE / 64]; // bit s = bucket s is non-empty
+        unsigned long long summary;                      // bit w = bits[w] != 0
+    } BucketQueue;
+
+    BucketQueue* bucket_queue_create();
+
+    int bucket_queue_fits(int severity);
+
+    void bucket_queue_insert(BucketQueue* q, BucketNode* node);
+
+    void bucket_queue_remove(BucketQueue* q, BucketNode* node);
+
+    BucketNode* bucket_queue_top(BucketQueue* q);
+
+    int bucket_queue_empty(BucketQueue* q);
+
+    // Calls fn on the next k nodes in queue order, without removing them
+    void bucket_queue_top_k(BucketQueue* q, int k, void (*fn)(BucketNode* node, void* ctx), void* ctx);
+
+    void bucket_queue_free(BucketQueue* q);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
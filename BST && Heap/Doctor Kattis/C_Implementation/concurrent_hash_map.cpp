@@ -0,0 +1,109 @@
+/* =====================================================================
+ * SHARDED CONCURRENT HASH MAP
+ * =====================================================================
+ *
+ * hash_map_t is not thread safe: a put can resize the table (or move
+ * entries during an incremental resize) while another thread reads it.
+ * One big lock around it works, but then every thread waits for every
+ * other thread.
+ *
+ * SHARDING:
+ * We keep shard_count independent hash_map_t's, each with its own lock.
+ * The key's hash decides the shard, so two threads only wait for each
+ * other when their keys land in the same shard (1 in shard_count).
+ *
+ * READ-WRITE LOCKS:
+ * Each shard uses a pthread rwlock: any number of gets can run together,
+ * a put/delete waits until it has the shard for itself.
+ * hash_map_get never modifies the map (see INCREMENTAL RESIZING in
+ * hash_set.cpp), so a read lock is enough for it.
+ *
+ * WHICH HASH BITS?
+ *   table index   -> low bits
+ *   Swiss tag     -> top 7 bits
+ *   shard         -> bits 32 and up (so it doesn't repeat either of them)
+ * The hash is computed once and passed down with the *_hashed functions.
+ *
+ * Values are just pointers: the map does not protect what they point to.
+ * ===================================================================== */
+
+#include "concurrent_hash_map.h"
+#include <stdlib.h>
+
+static_assert(alignof(hash_map_shard_t) == SHARD_CACHE_LINE && sizeof(hash_map_shard_t) % SHARD_CACHE_LINE == 0,
+              "every shard on its own cache line(s)");
+
+static unsigned round_up_pow2(unsigned n) {
+    unsigned p = 1;
+    while (p < n)
+        p <<= 1;
+    return p;
+}
+
+static inline hash_map_shard_t* shard_for(concurrent_hash_map_t* map, unsigned long long h) {
+    return &map->shards[(h >> 32) & (map->shard_count - 1)];
+}
+
+concurrent_hash_map_t* init_concurrent_hash_map(unsigned shard_count) {
+    concurrent_hash_map_t* map = (concurrent_hash_map_t*)malloc(sizeof(concurrent_hash_map_t));
+    map->shard_count = round_up_pow2(shard_count ? shard_count : DEFAULT_SHARD_COUNT);
+
+    // malloc only promises 16 bytes; the array has to start on a line too.
+    // sizeof(hash_map_shard_t) is a multiple of the line, as aligned_alloc wants
+    size_t bytes = map->shard_count * sizeof(hash_map_shard_t);
+    map->shards = (hash_map_shard_t*)aligned_alloc(SHARD_CACHE_LINE, bytes);
+
+    for (unsigned i = 0; i < map->shard_count; ++i) {
+        pthread_rwlock_init(&map->shards[i].lock, NULL);
+        map->shards[i].map = init_hash_map();
+    }
+    return map;
+}
+
+void* concurrent_hash_map_get(concurrent_hash_map_t* map, const char* key) {
+    unsigned long long h = hash_str(key);
+    hash_map_shard_t* s = shard_for(map, h);
+
+    pthread_rwlock_rdlock(&s->lock);
+    void* value = hash_map_get_hashed(s->map, key, h);
+    pthread_rwlock_unlock(&s->lock);
+    return value;
+}
+
+void concurrent_hash_map_put(concurrent_hash_map_t* map, const char* key, void* value) {
+    unsigned long long h = hash_str(key);
+    hash_map_shard_t* s = shard_for(map, h);
+
+    pthread_rwlock_wrlock(&s->lock);
+    hash_map_put_hashed(s->map, key, h, value);
+    pthread_rwlock_unlock(&s->lock);
+}
+
+void concurrent_hash_map_delete(concurrent_hash_map_t* map, const char* key) {
+    unsigned long long h = hash_str(key);
+    hash_map_shard_t* s = shard_for(map, h);
+
+    pthread_rwlock_wrlock(&s->lock);
+    hash_map_delete_hashed(s->map, key, h);
+    pthread_rwlock_unlock(&s->lock);
+}
+
+// Sum over all shards - not a snapshot if other threads are writing
+unsigned concurrent_hash_map_length(concurrent_hash_map_t* map) {
+    unsigned total = 0;
+    for (unsigned i = 0; i < map->shard_count; ++i) {
+        pthread_rwlock_rdlock(&map->shards[i].lock);
+        total += map->shards[i].map->length;
+        pthread_rwlock_unlock(&map->shards[i].lock);
+    }
+    return total;
+}
+
+void free_concurrent_hash_map(concurrent_hash_map_t* map) {
+    for (unsigned i = 0; i < map->shard_count; ++i) {
+        pthread_rwlock_destroy(&map->shards[i].lock);
+        free_hash_map(map->shards[i].map);
+    }
+    free(map->shards);
+    free(map);
+}
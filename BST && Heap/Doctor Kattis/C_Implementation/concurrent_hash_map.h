@@ -0,0 +1,36 @@
+#ifndef C_IMPLEMENTATION_CONCURRENT_HASH_MAP_H
+#define C_IMPLEMENTATION_CONCURRENT_HASH_MAP_H
+
+#include <pthread.h>
+#include "hash_set.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DEFAULT_SHARD_COUNT 64
+#define SHARD_CACHE_LINE 64
+
+    // One hash_map_t + its lock, aligned (and so padded) so two shards never share a cache line
+    typedef struct alignas(SHARD_CACHE_LINE) {
+        pthread_rwlock_t lock;
+        hash_map_t* map;
+    } hash_map_shard_t;
+
+    typedef struct {
+        unsigned shard_count; // power of 2
+        hash_map_shard_t* shards;
+    } concurrent_hash_map_t;
+
+    concurrent_hash_map_t* init_concurrent_hash_map(unsigned shard_count);
+    void* concurrent_hash_map_get(concurrent_hash_map_t* map, const char* key);
+    void concurrent_hash_map_put(concurrent_hash_map_t* map, const char* key, void* value);
+    void concurrent_hash_map_delete(concurrent_hash_map_t* map, const char* key);
+    unsigned concurrent_hash_map_length(concurrent_hash_map_t* map);
+    void free_concurrent_hash_map(concurrent_hash_map_t* map);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
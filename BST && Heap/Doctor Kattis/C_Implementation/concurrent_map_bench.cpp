@@ -0,0 +1,146 @@
+// Benchmark: throughput of concurrent_hash_map_t with 1, 2, 4, ... threads
+// Usage: ./concurrent_map_bench [keys] [max_threads] [write_percent] [shards]
+//        defaults: 1000000 keys, hardware threads, 10% writes, 64 shards
+//
+// Every thread runs the same number of operations on random keys
+// (90% get / 10% put by default), so with perfect scaling the
+// total Mops/s grows linearly with the thread count.
+//
+// After each round (untimed) the map is checked: every get found its
+// key, and every key holds the value of the last put some thread of the
+// round made to it - or its value from before, if none did. A put's
+// value says which thread at which step, the steps are replayed from
+// the thread's seed. Exits 1 if something is lost or mixed up.
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <random>
+#include <cstdlib>
+#include "concurrent_hash_map.h"
+
+using namespace std;
+using Clock = chrono::steady_clock;
+
+static const size_t OPS_PER_THREAD = 2000000;
+
+// A put's value: (step + 1) << 16 | writer. Writers of a round with t
+// threads are t .. 2t-1, so no two rounds share one, 0 = the preload
+static uintptr_t put_value(size_t op, unsigned writer) { return (uintptr_t)(op + 1) << 16 | writer; }
+
+// The operations of one writer, in order: f(step, key index, is_put).
+// The timed run and the check both go through here, so they agree
+template <class F>
+static void run_ops(unsigned writer, size_t n, unsigned write_percent, F&& f) {
+    mt19937_64 rng(writer);
+    for (size_t op = 0; op < OPS_PER_THREAD; ++op) {
+        size_t key = rng() % n;
+        f(op, key, rng() % 100 < write_percent);
+    }
+}
+
+// The map after a round of t threads; before = the values it had going
+// in, updated to the ones it has now. "" or what is wrong
+static string check_round(concurrent_hash_map_t* map, const vector<string>& keys, vector<uintptr_t>& before,
+                          unsigned t, unsigned write_percent) {
+    size_t n = keys.size();
+    if (concurrent_hash_map_length(map) != n)
+        return "the map has " + to_string(concurrent_hash_map_length(map)) + " keys";
+    vector<uintptr_t> now(n);
+    for (size_t i = 0; i < n; ++i)
+        now[i] = (uintptr_t)concurrent_hash_map_get(map, keys[i].c_str());
+
+    vector<char> written(n, 0);
+    vector<size_t> last(n);
+    for (unsigned writer = t; writer < 2 * t; ++writer) {
+        fill(last.begin(), last.end(), 0);
+        run_ops(writer, n, write_percent, [&](size_t op, size_t key, bool put) {
+            if (put) {
+                last[key] = op + 1;
+                written[key] = 1;
+            }
+        });
+        for (size_t i = 0; i < n; ++i)
+            if ((now[i] & 0xffff) == writer && now[i] != put_value(last[i] - 1, writer))
+                return keys[i] + " doesn't hold the last put of the thread that wrote it";
+    }
+    for (size_t i = 0; i < n; ++i) {
+        unsigned writer = now[i] & 0xffff;
+        if ((writer < t || writer >= 2 * t) && (written[i] || now[i] != before[i]))
+            return keys[i] + (written[i] ? " lost its puts" : " changed without a put");
+    }
+    before.swap(now);
+    return "";
+}
+
+int main(int argc, char** argv) {
+    size_t n = argc > 1 ? strtoull(argv[1], nullptr, 10) : 1000000;
+    unsigned max_threads = argc > 2 ? atoi(argv[2]) : thread::hardware_concurrency();
+    unsigned write_percent = argc > 3 ? atoi(argv[3]) : 10;
+    unsigned shards = argc > 4 ? atoi(argv[4]) : DEFAULT_SHARD_COUNT;
+    if (max_threads == 0) max_threads = 1;
+    if (max_threads > 0x7fff) max_threads = 0x7fff;  // writers up to 2t - 1 fit in 16 bits
+
+    vector<string> keys;
+    keys.reserve(n);
+    for (size_t i = 0; i < n; ++i)
+        keys.push_back("patient_from_clinic_" + to_string(i));
+
+    concurrent_hash_map_t* map = init_concurrent_hash_map(shards);
+    vector<uintptr_t> contents(n);
+    for (size_t i = 0; i < n; ++i) {
+        contents[i] = put_value(i, 0);
+        concurrent_hash_map_put(map, keys[i].c_str(), (void*)contents[i]);
+    }
+
+    cout << n << " keys, " << map->shard_count << " shards, " << write_percent << "% puts\n";
+    cout << setw(8) << "threads" << setw(12) << "Mops/s" << setw(10) << "speedup" << "\n";
+
+    double single = 0;
+    for (unsigned t = 1; t <= max_threads; t <<= 1) {
+        vector<thread> workers;
+        vector<size_t> missed(t, 0);
+
+        auto start = Clock::now();
+        for (unsigned id = 0; id < t; ++id) {
+            workers.emplace_back([&, id] {
+                unsigned writer = t + id;
+                size_t misses = 0;
+                run_ops(writer, n, write_percent, [&](size_t op, size_t key, bool put) {
+                    if (put)
+                        concurrent_hash_map_put(map, keys[key].c_str(), (void*)put_value(op, writer));
+                    else
+                        misses += concurrent_hash_map_get(map, keys[key].c_str()) == nullptr;
+                });
+                missed[id] = misses;
+            });
+        }
+        for (thread& w : workers)
+            w.join();
+        double seconds = chrono::duration<double>(Clock::now() - start).count();
+
+        string error = check_round(map, keys, contents, t, write_percent);
+        for (size_t misses : missed)
+            if (misses && error.empty())
+                error = to_string(misses) + " gets didn't find their key";
+        if (!error.empty()) {
+            cerr << "FAIL with " << t << " threads: " << error << "\n";
+            free_concurrent_hash_map(map);
+            return 1;
+        }
+
+        double mops = t * OPS_PER_THREAD / seconds / 1e6;
+        if (t == 1) single = mops;
+        cout << setw(8) << t << setw(12) << fixed << setprecision(2) << mops
+             << setw(9) << setprecision(2) << mops / single << "x\n";
+    }
+
+    cout << "contents checked after every round: no lost or stray puts\n";
+    free_concurrent_hash_map(map);
+    return 0;
+}
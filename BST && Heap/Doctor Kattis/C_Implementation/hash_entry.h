@@ -0,0 +1,42 @@
+#ifndef C_IMPLEMENTATION_HASH_ENTRY_H
+#define C_IMPLEMENTATION_HASH_ENTRY_H
+
+// Key storage helpers shared by hash_set.cpp and swiss_table.cpp
+//
+// Short keys (up to HASH_KEY_INLINE chars) are copied into the entry itself.
+// Longer keys live in map->keys and the entry holds a pointer; the last byte
+// of the inline buffer is then set to KEY_IN_ARENA. For inline keys that byte
+// is always '\0' (terminator or padding), so the two cases can't be confused.
+
+#include "hash_set.h"
+#include "key_arena.h"
+#include <string.h>
+
+#define KEY_IN_ARENA 1
+
+static inline int entry_key_in_arena(const hash_entry_t* e) {
+    return e->key.inline_key[HASH_KEY_INLINE] == KEY_IN_ARENA;
+}
+
+static inline const char* entry_key(const hash_entry_t* e) {
+    return entry_key_in_arena(e) ? e->key.arena_key : e->key.inline_key;
+}
+
+static inline void entry_store_key(hash_map_t* map, hash_entry_t* e, const char* key) {
+    size_t len = strlen(key);
+    if (len <= HASH_KEY_INLINE) {
+        memset(e->key.inline_key, 0, sizeof(e->key.inline_key));
+        memcpy(e->key.inline_key, key, len);
+    } else {
+        e->key.arena_key = key_arena_strdup(&map->keys, key, len);
+        e->key.inline_key[HASH_KEY_INLINE] = KEY_IN_ARENA;
+    }
+}
+
+static inline void entry_release_key(hash_map_t* map, hash_entry_t* e) {
+    if (entry_key_in_arena(e))
+        key_arena_release(&map->keys, e->key.arena_key);
+    memset(e, 0, sizeof(*e));
+}
+
+#endif
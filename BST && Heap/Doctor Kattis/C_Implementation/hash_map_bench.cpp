@@ -0,0 +1,97 @@
+// Benchmark: linear probing hash_map_t vs the Swiss table backend
+// Usage: ./hash_map_bench [number_of_keys]   (default 1000000)
+//
+// Keys look like our patient names: long shared prefix, short varying tail.
+// Every put is also timed on its own: p99 / p999 / worst show the pauses
+// a resize causes, which the average hides.
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cstdlib>
+#include "hash_set.h"
+
+using namespace std;
+using Clock = chrono::steady_clock;
+
+static double ns_per_op(Clock::time_point start, size_t ops) {
+    return chrono::duration<double, nano>(Clock::now() - start).count() / ops;
+}
+
+// q-quantile of the samples (reorders them)
+static double percentile(vector<float>& samples, double q) {
+    size_t k = min(samples.size() - 1, (size_t)(q * samples.size()));
+    nth_element(samples.begin(), samples.begin() + k, samples.end());
+    return samples[k];
+}
+
+static void run(const char* label, hash_map_t* (*make)(), const vector<string>& keys,
+                const vector<string>& missing, const vector<size_t>& order) {
+    hash_map_t* map = make();
+    size_t n = keys.size();
+    size_t checksum = 0;
+
+    vector<float> put_us(n);
+    auto t = Clock::now();
+    for (size_t i = 0; i < n; ++i) {
+        auto one = Clock::now();
+        hash_map_put(map, keys[i].c_str(), (void*)(i + 1));
+        put_us[i] = chrono::duration<float, micro>(Clock::now() - one).count();
+    }
+    double put = ns_per_op(t, n);
+    double p99 = percentile(put_us, 0.99), p999 = percentile(put_us, 0.999);
+    double worst_put = *max_element(put_us.begin(), put_us.end());
+
+    t = Clock::now();
+    for (size_t i : order)
+        checksum += (size_t)hash_map_get(map, keys[i].c_str());
+    double hit = ns_per_op(t, n);
+
+    t = Clock::now();
+    for (const string& k : missing)
+        checksum += (size_t)hash_map_get(map, k.c_str());
+    double miss = ns_per_op(t, n);
+
+    // Churn: delete a key and put it back, like a discharge + re-admission
+    t = Clock::now();
+    for (size_t i : order) {
+        hash_map_delete(map, keys[i].c_str());
+        hash_map_put(map, keys[i].c_str(), (void*)(i + 1));
+    }
+    double churn = ns_per_op(t, n);
+
+    free_hash_map(map);
+
+    cout << left << setw(16) << label << right << fixed << setprecision(1)
+         << setw(10) << put << setw(10) << hit << setw(10) << miss << setw(10) << churn
+         << setw(10) << setprecision(2) << p99 << setw(10) << p999 << setw(10) << setprecision(1) << worst_put
+         << "   (checksum " << checksum << ")\n";
+}
+
+int main(int argc, char** argv) {
+    size_t n = argc > 1 ? strtoull(argv[1], nullptr, 10) : 1000000;
+
+    vector<string> keys, missing;
+    keys.reserve(n);
+    missing.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        keys.push_back("patient_from_clinic_" + to_string(i));
+        missing.push_back("patient_from_clinic_" + to_string(i + n));
+    }
+
+    vector<size_t> order(n);
+    for (size_t i = 0; i < n; ++i) order[i] = i;
+    shuffle(order.begin(), order.end(), mt19937(123));
+
+    cout << n << " keys, ns per operation (put percentiles and worst put in microseconds)\n";
+    cout << left << setw(16) << "backend" << right
+         << setw(10) << "put" << setw(10) << "get hit" << setw(10) << "get miss" << setw(10) << "churn"
+         << setw(10) << "put p99" << setw(10) << "put p999" << setw(10) << "worst" << "\n";
+    run("linear probing", init_hash_map, keys, missing, order);
+    run("swiss table", init_swiss_hash_map, keys, missing, order);
+    return 0;
+}
@@ -0,0 +1,157 @@
+#include "hash_map_test.h"
+#include "hash_set.h"
+#include "hash_entry.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <unordered_map>
+
+/* =====================================================================
+ * Randomized test for hash_map_t
+ * =====================================================================
+ * n operations, each a put (new key or overwrite), a delete (of a key
+ * that is there or not) or a get, in phases that grow the map and
+ * shrink it again - each growing phase a bit longer, so it keeps passing
+ * its old size and resizing. After every operation the key it touched
+ * is looked up, and every 64 operations (and around every resize) the
+ * whole map is compared with the reference std::unordered_map:
+ *   - length, and every reference key's value through hash_map_get
+ *   - hash_map_foreach sees every key exactly once, nothing else
+ *   - linear probing: old_length is the number of entries left in the
+ *     old table, and nothing before migrate_pos is still in it
+ * Half the names are longer than HASH_KEY_INLINE, so puts, overwrites
+ * and deletes go through the key arena as often as the inline keys.
+ * The linear probing map resizes incrementally; deletes that hit a key
+ * still in old_table (the tombstone path) are counted and must happen.
+ * Same seed, same test - a failure can be replayed.
+ * ===================================================================== */
+
+typedef std::unordered_map<std::string, uintptr_t> Reference;
+
+static std::string name_of(unsigned id) {
+    if (id % 2)
+        return "patient-with-a-long-name-" + std::to_string(id);  // > HASH_KEY_INLINE: the arena
+    return "p" + std::to_string(id);
+}
+
+// Is key among the entries of old_table that haven't moved yet?
+static bool in_old_table(const hash_map_t* map, const std::string& key) {
+    if (!map->old_table)
+        return false;
+    for (unsigned i = map->migrate_pos; i < map->old_capacity; i++)
+        if (map->old_table[i].hash > 1 && key == entry_key(&map->old_table[i]))
+            return true;
+    return false;
+}
+
+struct Seen {
+    Reference keys;
+    bool twice = false;
+};
+
+static void collect(const char* key, void* value, void* ctx) {
+    Seen* seen = (Seen*)ctx;
+    seen->twice |= !seen->keys.emplace(key, (uintptr_t)value).second;
+}
+
+static std::string check(hash_map_t* map, const Reference& reference) {
+    if (map->length != reference.size())
+        return "length differs from the reference";
+    for (const auto& [key, value] : reference)
+        if ((uintptr_t)hash_map_get(map, key.c_str()) != value)
+            return "hash_map_get of a key differs from the reference";
+
+    Seen seen;
+    hash_map_foreach(map, collect, &seen);
+    if (seen.twice)
+        return "hash_map_foreach saw a key twice";
+    if (seen.keys != reference)
+        return "hash_map_foreach differs from the reference";
+
+    if (map->old_table) {
+        unsigned left = 0;
+        for (unsigned i = 0; i < map->old_capacity; i++) {
+            if (map->old_table[i].hash <= 1)
+                continue;
+            if (i < map->migrate_pos)
+                return "an entry before migrate_pos is still in the old table";
+            left++;
+        }
+        if (left != map->old_length)
+            return "old_length differs from the entries left in the old table";
+    }
+    return "";
+}
+
+std::string run_hash_map_generated_test(int n, unsigned seed, bool swiss) {
+    std::cout << "[HASHMAP-TEST] START n=" << n << " seed=" << seed << " swiss=" << swiss << std::endl;
+
+    hash_map_t* map = swiss ? init_swiss_hash_map() : init_hash_map();
+    Reference reference;
+    std::mt19937 rng(seed);
+    const unsigned names = n / 2 + 1;
+    int resizes = 0, deletes_in_old_table = 0;
+
+    auto fail = [&](int step, const char* op, const std::string& key, const std::string& why) {
+        std::ostringstream oss;
+        oss << "FAIL: " << why << " | after " << op << " \"" << key << "\" | step=" << step
+            << " | length=" << map->length << " | n=" << n << " | seed=" << seed << " | swiss=" << swiss;
+        free_hash_map(map);
+        return oss.str();
+    };
+
+    int phase_end = 0, phase = 0;
+    bool growing = false;
+    for (int step = 0; step < n; step++) {
+        // growing phases: 5 puts to 2 deletes, shrinking ones the other
+        // way round; the growing ones get longer, so the map keeps growing
+        if (step == phase_end) {
+            growing = phase % 2 == 0;
+            phase_end = step + std::max(1, n / 16) * (growing ? 2 + phase / 2 : 1);
+            phase++;
+        }
+        unsigned r = rng() % 8;
+        std::string key = name_of(rng() % names);
+        unsigned capacity_before = map->capacity;
+        bool migrating_before = map->old_table != NULL;
+        const char* op;
+
+        if (r < (growing ? 5u : 2u)) {
+            op = "PUT";
+            uintptr_t value = rng() % 1000 + 1;  // never NULL, that's "not there"
+            hash_map_put(map, key.c_str(), (void*)value);
+            reference[key] = value;
+        } else if (r < 7) {
+            op = "DELETE";
+            deletes_in_old_table += in_old_table(map, key);
+            hash_map_delete(map, key.c_str());
+            reference.erase(key);
+        } else {
+            op = "GET";
+        }
+
+        auto it = reference.find(key);
+        if ((uintptr_t)hash_map_get(map, key.c_str()) != (it == reference.end() ? 0 : it->second))
+            return fail(step, op, key, "hash_map_get differs from the reference");
+
+        bool resized = map->capacity != capacity_before;
+        resizes += resized;
+        if (resized || migrating_before != (map->old_table != NULL) || step % 64 == 63 || step == n - 1) {
+            std::string why = check(map, reference);
+            if (!why.empty())
+                return fail(step, op, key, why);
+        }
+    }
+
+    if (!swiss && resizes && !deletes_in_old_table)
+        return fail(n - 1, "END", "", "no delete hit a key still in the old table");
+
+    std::ostringstream oss;
+    oss << "PASS: " << n << " operations, " << reference.size() << " keys left, " << resizes << " resizes, "
+        << deletes_in_old_table << " deletes from the old table | seed=" << seed << " | swiss=" << swiss;
+    free_hash_map(map);
+    return oss.str();
+}
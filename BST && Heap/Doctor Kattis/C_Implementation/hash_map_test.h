@@ -0,0 +1,11 @@
+#ifndef C_IMPLEMENTATION_HASH_MAP_TEST_H
+#define C_IMPLEMENTATION_HASH_MAP_TEST_H
+
+#include <string>
+
+// Random puts, gets and deletes on a hash_map_t (swiss = the Swiss table
+// backend), short and arena keys mixed, checked against a std::map.
+// "PASS ..." or "FAIL: ..." with the step
+std::string run_hash_map_generated_test(int n, unsigned seed = 123456789u, bool swiss = false);
+
+#endif
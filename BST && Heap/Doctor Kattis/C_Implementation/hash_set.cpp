@@ -20,46 +20,77 @@
  * ===================================================================== */
 
 #include "hash_set.h"
+#include "swiss_table.h"
+#include "hash_entry.h"
 #include <stdlib.h>
 #include <string.h>
 
 /* =====================================================================
- * hash_str: Converts a string into a hash value (index number)
+ * hash_str: Converts a string into a 64-bit hash value
  * =====================================================================
  * This is the "hashing" step - converting a string key into a number
  * that represents where it should go in our array.
  *
- * ALGORITHM USED: Polynomial rolling hash
+ * ALGORITHM USED: wyhash-style multiply-mix, 8 bytes at a time
  *
- * PARAMETERS:
- *   a = running sum of character values
- *   b = running sum of the running sums (adds positional weight)
- *   MOD = modulo value (65521) to keep numbers manageabl\'
+ * The old version was an Adler-32 style sum (two running sums mod 65521).
+ * It only had ~32 useful bits and names with a long shared prefix
+ * ("patient_000123", "patient_000124") ended up with almost the same
+ * hash, so they piled up next to each other and probe chains got long.
  *
- * WHY TWO VALUES (a and b)?
- *   Using both components gives us a better distribution - reduces collisions
- *   where two different strings would hash to the same number.
+ * HOW IT WORKS:
+ *   - Read the string one 64-bit word at a time (memcpy, so unaligned is fine)
+ *   - XOR every word with a large odd constant and multiply two of them
+ *     together into a 128-bit product
+ *   - Fold the product: low 64 bits XOR high 64 bits (mix64)
+ *   Every input bit ends up affecting every output bit, which is what
+ *   we need so that similar names land far apart in the table.
  *
- * FINAL STEP:
- *   ((long long)b << 16) | a
- *   This combines 'a' and 'b' into a single 64-bit number:
- *   - Shifts 'b' left 16 bits (makes room for 'a')
- *   - Uses bitwise OR to merge them
+ * The length is mixed in at the end so "a" and "a\0\0" never collide
+ * via the zero padding of the last word.
  *
- * EXAMPLE: "Hi"
- *   'H' = 72, 'i' = 105
- *   After processing, might produce something like: 12345678
+ * 0 marks an empty slot and 1 a tombstone (see INCREMENTAL RESIZING),
+ * so those two (1 in 2^63) values are shifted out of the way.
  * ===================================================================== */
-long long hash_str(const char* str) {
-    int a = 1, b = 0;  // Initialize a to 1 (multiplicative identity)
-    const int MOD = 65521;  // Modulo prevents integer overflow
-    for (int i = 0; str[i]; ++i) {
-        a = (a + (unsigned char)str[i]) % MOD;
-        // Add the updated 'a' to 'b' (gives positional information)
-        b = (b + a) % MOD;
+static const unsigned long long P0 = 0xa0761d6478bd642fULL;
+static const unsigned long long P1 = 0xe7037ed1a0b428dbULL;
+static const unsigned long long P2 = 0x8ebc6af09c88c6dbULL;
+
+static inline unsigned long long mix64(unsigned long long a, unsigned long long b) {
+    __uint128_t r = (__uint128_t)a * b;
+    return (unsigned long long)r ^ (unsigned long long)(r >> 64);
+}
+
+static inline unsigned long long read64(const char* p) {
+    unsigned long long v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+unsigned long long hash_str(const char* str) {
+    size_t len = strlen(str);
+    const char* p = str;
+    size_t left = len;
+    unsigned long long seed = P0;
+
+    // Main loop: 16 bytes (two words) per round
+    while (left > 16) {
+        seed = mix64(read64(p) ^ P1, read64(p + 8) ^ seed);
+        p += 16;
+        left -= 16;
     }
-    // Combine both hash values into one 64-bit number and return
-    return ((long long)b << 16) | a;
+
+    // Tail: up to 16 bytes left, pad the missing bytes with zeros
+    unsigned long long a = 0, b = 0;
+    if (left > 8) {
+        a = read64(p);
+        memcpy(&b, p + 8, left - 8);
+    } else {
+        memcpy(&a, p, left);
+    }
+
+    unsigned long long h = mix64(P1 ^ len, mix64(a ^ P1, b ^ seed ^ P2));
+    return h > 1 ? h : h + 2;
 }
 
 /* =====================================================================
@@ -68,14 +99,11 @@ long long hash_str(const char* str) {
  * Takes the large hash number and converts it to a valid array position
  * (0 to capacity-1).
  *
- * BITWISE OPERATION BREAKDOWN:
- *   (cap - 1) & (h ^ (h >> 12))
+ *   (cap - 1) & h
  *
- *   h >> 12:       Right shift h by 12 bits (divide by 4096 approximately)
- *   h ^ (h >> 12): XOR operation - mixes high and low bits together
- *                  (helps distribute collisions more evenly)
- *   (cap - 1) &:   Bitwise AND with (capacity - 1)
- *                  This is a fast way to do modulo when capacity is a power of 2
+ * Since hash_str already mixes every bit, we can just keep the low bits.
+ * Bitwise AND with (capacity - 1) is a fast way to do modulo when
+ * capacity is a power of 2.
  *
  * WHY POWER OF 2?
  *   If capacity = 16 (binary: 10000), then capacity - 1 = 15 (binary: 01111)
@@ -85,8 +113,8 @@ long long hash_str(const char* str) {
  *   h   - The hash value from hash_str()
  *   cap - Current capacity of the hash table
  * ===================================================================== */
-static unsigned index_from_hash(long long h, unsigned cap) {
-    return (cap - 1) & (h ^ (h >> 12));
+static unsigned index_from_hash(unsigned long long h, unsigned cap) {
+    return (unsigned)(h & (cap - 1));
 }
 
 hash_map_t* init_hash_map() {
@@ -94,93 +122,381 @@ hash_map_t* init_hash_map() {
     map->capacity = DEFAULT_HASH_SET_CAPACITY;
     map->length = 0;
     map->table = (hash_entry_t*)calloc(map->capacity, sizeof(hash_entry_t));
+    map->ctrl = NULL;
+    map->tombstones = 0;
+    map->old_table = NULL;
+    map->old_capacity = map->old_length = map->migrate_pos = 0;
+    map->next_table = NULL;
+    map->prefault_done = map->prefault_credit = 0;
+    key_arena_init(&map->keys);
     return map;
 }
 
-static void resize(hash_map_t* map) {
-    unsigned oldcap = map->capacity;  // Save the old capacity
-    hash_entry_t* oldtab = map->table;  // Save the old table
+hash_map_t* init_swiss_hash_map() {
+    hash_map_t* map = (hash_map_t*)malloc(sizeof(hash_map_t));
+    swiss_init(map, DEFAULT_HASH_SET_CAPACITY);
+    map->old_table = NULL;  // the Swiss backend always rehashes in one go (swiss_table.cpp)
+    map->old_capacity = map->old_length = map->migrate_pos = 0;
+    map->next_table = NULL;
+    map->prefault_done = map->prefault_credit = 0;
+    key_arena_init(&map->keys);
+    return map;
+}
 
-    map->capacity <<= 1;
-    map->table = (hash_entry_t*)calloc(map->capacity, sizeof(hash_entry_t));
-    map->length = 0;
+/* =====================================================================
+ * hash_map_reserve: Sizes an EMPTY map for n keys up front
+ * =====================================================================
+ * Growing from 1024 slots to millions means ~12 resizes, each with its
+ * own calloc and a migration of everything stored so far. When the
+ * caller knows the final size (e.g. loading a snapshot) it is cheaper
+ * to allocate the final table once. Does nothing on a non-empty map.
+ * ===================================================================== */
+void hash_map_reserve(hash_map_t* map, unsigned n) {
+    if (map->length || map->old_table)
+        return;
+    unsigned capacity = DEFAULT_HASH_SET_CAPACITY;
+    if (map->ctrl) {
+        while (capacity - capacity / 8 <= n) capacity <<= 1;  // Swiss: 7/8 max load
+    } else {
+        while (capacity <= n * 2ULL) capacity <<= 1;          // linear probing: < 50%
+    }
+    if (capacity <= map->capacity)
+        return;
+
+    free(map->next_table);  // sized for the old capacity
+    map->next_table = NULL;
+    map->prefault_done = map->prefault_credit = 0;
+    free(map->table);
+    if (map->ctrl) {
+        free(map->ctrl);
+        swiss_init(map, capacity);
+    } else {
+        map->capacity = capacity;
+        map->table = (hash_entry_t*)calloc(capacity, sizeof(hash_entry_t));
+    }
+}
+
+/* =====================================================================
+ * INCREMENTAL RESIZING
+ * =====================================================================
+ * Doubling the table by moving every entry in one loop is O(n) for that
+ * single put - with millions of keys that one call takes milliseconds.
+ *
+ * Instead, when the load factor hits 50% we only allocate the bigger
+ * table and keep the old one around:
+ *
+ *   old_table  - entries not moved yet (everything before migrate_pos is done)
+ *   table      - the new table, all new keys go here
+ *
+ * Every put/delete then moves the next MIGRATE_STEP slots of the old table
+ * into the new one. get never moves anything (it stays read-only), it just
+ * looks in the new table first and then in the old one.
+ *
+ * WHY IT FINISHES IN TIME:
+ * The new table starts at 25% load and we resize again at 50%, so at least
+ * old_capacity / 2 puts happen before that. With MIGRATE_STEP = 4 those
+ * puts alone move 2 * old_capacity slots - twice what is needed.
+ *
+ * TOMBSTONES IN THE OLD TABLE:
+ * Slots already moved, and keys deleted from the old table, become
+ * TOMBSTONE_HASH instead of empty. An empty slot would cut a probe chain in
+ * half and hide keys further along it. (The backward shift trick could
+ * move a key behind migrate_pos where it would never be migrated.)
+ * The old table is thrown away at the end, tombstones and all.
+ *
+ * PAGE FAULTS:
+ * calloc() of a big table only reserves address space, the OS hands out
+ * (and zeroes) each 4 KB page the first time it is written. Moving the
+ * resize into small steps also spread those faults over the puts: a new
+ * table of 2M slots is ~20k faults, so 2% of all puts paid ~2-5 us for
+ * one, and p99 / p999 got WORSE than with the old stop-the-world resize.
+ *
+ * So the next table is allocated before it is needed - once the last
+ * migration is over and the load passes 7/16 - and faulted in ahead of
+ * time: every put earns PREFAULT_PER_PUT bytes of credit, and once
+ * PREFAULT_BATCH bytes are earned one put writes a byte into each of
+ * those pages. Twice the rate that finishes before the resize at 50%,
+ * and only 1 put in PREFAULT_BATCH / PREFAULT_PER_PUT (~800) of that
+ * stretch does the touching: ~1 ms each, but too few to reach p999.
+ * Peak memory doesn't change - a resize holds both tables at once anyway.
+ * The price: a map that stops growing between 7/16 and 1/2 load keeps
+ * the (already faulted) next table until it grows again or is freed.
+ * ===================================================================== */
+#define MIGRATE_STEP 4
+#define TOMBSTONE_HASH 1ULL
+#define PREFAULT_PER_PUT (64 * sizeof(hash_entry_t))
+#define PREFAULT_BATCH (2u << 20)
+#define PAGE_SIZE_GUESS 4096  // smaller than the real page size is only slower, never wrong
 
-    for (unsigned i = 0; i < oldcap; ++i) {
-        if (oldtab[i].key) {
-            // Re-hash this entry in the new, larger table
-            long long h = hash_str(oldtab[i].key);
-            unsigned idx = index_from_hash(h, map->capacity);
+// Linear probing insert of an entry whose key is known to be absent
+static void place_entry(hash_entry_t* table, unsigned capacity, const hash_entry_t* e) {
+    unsigned idx = index_from_hash(e->hash, capacity);
+    while (table[idx].hash)
+        idx = (idx + 1) & (capacity - 1);
+    table[idx] = *e;
+}
 
-            while (map->table[idx].key)
-                idx = (idx + 1) % map->capacity;
+static void migrate_step(hash_map_t* map, unsigned slots) {
+    unsigned end = map->migrate_pos + slots;
+    if (end > map->old_capacity)
+        end = map->old_capacity;
 
-            map->table[idx].key = oldtab[i].key;
-            map->table[idx].value = oldtab[i].value;
-            map->length++;
+    for (unsigned i = map->migrate_pos; i < end; ++i) {
+        hash_entry_t* e = &map->old_table[i];
+        if (e->hash > TOMBSTONE_HASH) {
+            // Move using the stored hash, the key string is never read
+            place_entry(map->table, map->capacity, e);
+            map->old_length--;
+            e->hash = TOMBSTONE_HASH;
         }
     }
+    map->migrate_pos = end;
+
+    if (map->migrate_pos == map->old_capacity) {
+        free(map->old_table);
+        map->old_table = NULL;
+        map->old_capacity = 0;
+    }
+}
+
+static void start_resize(hash_map_t* map) {
+    if (map->old_table)  // still moving the last resize - should not happen, but finish it
+        migrate_step(map, map->old_capacity);
+
+    map->old_table = map->table;
+    map->old_capacity = map->capacity;
+    map->old_length = map->length;
+    map->migrate_pos = 0;
+
+    map->capacity <<= 1;
+    if (map->next_table) {  // usually ready and faulted in by now
+        map->table = map->next_table;
+        map->next_table = NULL;
+    } else {
+        map->table = (hash_entry_t*)calloc(map->capacity, sizeof(hash_entry_t));
+    }
+    map->prefault_done = map->prefault_credit = 0;
+}
 
-    free(oldtab);
+// One put's share of getting the next table ready (see PAGE FAULTS above)
+static void prefault_step(hash_map_t* map) {
+    if (!map->next_table) {
+        if (map->old_table || map->length * 16ULL < map->capacity * 7ULL)
+            return;
+        map->next_table = (hash_entry_t*)calloc(map->capacity * 2ULL, sizeof(hash_entry_t));
+    }
+    unsigned long long bytes = map->capacity * 2ULL * sizeof(hash_entry_t);
+    if (map->prefault_done >= bytes)
+        return;
+    map->prefault_credit += PREFAULT_PER_PUT;
+    if (map->prefault_credit < PREFAULT_BATCH)
+        return;
+    map->prefault_credit = 0;
+
+    // The memory is zero already, writing a zero just makes the OS map the page
+    volatile char* p = (volatile char*)map->next_table;
+    unsigned long long end = map->prefault_done + PREFAULT_BATCH;
+    if (end > bytes)
+        end = bytes;
+    for (unsigned long long i = map->prefault_done; i < end; i += PAGE_SIZE_GUESS)
+        p[i] = 0;
+    p[end - 1] = 0;
+    map->prefault_done = end;
+}
+
+/* =====================================================================
+ * find_slot: Looks for key, returns its index or -1 if it is not there
+ * =====================================================================
+ * The stored hash is compared first - two different keys almost never
+ * share all 64 bits, so a wrong slot costs one integer compare and we
+ * only call strcmp when we have (almost certainly) found the key.
+ * Works for both the new and the old table (tombstones never match h).
+ * ===================================================================== */
+static long probe_from(const hash_entry_t* table, unsigned capacity, unsigned idx, const char* key,
+                       unsigned long long h) {
+    while (1) { //looks scary, but it is safe because we will always at least find an empty slot
+        const hash_entry_t* e = &table[idx];
+        if (!e->hash)
+            return -1;
+        if (e->hash == h && strcmp(entry_key(e), key) == 0)
+            return idx;
+        idx = (idx + 1) & (capacity - 1);
+    }
+}
+
+static long find_slot(const hash_entry_t* table, unsigned capacity, const char* key, unsigned long long h) {
+    return probe_from(table, capacity, index_from_hash(h, capacity), key, h);
+}
+
+/* The old table during a resize: a key still in it sits at or after
+ * migrate_pos (everything before has moved). If its home slot is before
+ * migrate_pos, every slot from home up to it was full when it went in,
+ * and is full or a tombstone now - so the probe may as well start at
+ * migrate_pos. Those slots are being migrated right now and are in the
+ * cache, which saves most puts during a resize a second cache miss. */
+static long find_old_slot(const hash_map_t* map, const char* key, unsigned long long h) {
+    unsigned idx = index_from_hash(h, map->old_capacity);
+    if (idx < map->migrate_pos)
+        idx = map->migrate_pos;
+    return probe_from(map->old_table, map->old_capacity, idx, key, h);
 }
 
 void hash_map_put(hash_map_t* map, const char* key, void* value) {
+    hash_map_put_hashed(map, key, hash_str(key), value);
+}
+
+void* hash_map_get(hash_map_t* map, const char* key) {
+    return hash_map_get_hashed(map, key, hash_str(key));
+}
+
+void hash_map_delete(hash_map_t* map, const char* key) {
+    hash_map_delete_hashed(map, key, hash_str(key));
+}
+
+// The *_hashed versions take h = hash_str(key) from a caller that already
+// computed it (e.g. to pick a shard in concurrent_hash_map.cpp)
+void hash_map_put_hashed(hash_map_t* map, const char* key, unsigned long long h, void* value) {
+    if (map->ctrl) {
+        swiss_put(map, key, h, value);
+        return;
+    }
+
+    if (map->old_table)
+        migrate_step(map, MIGRATE_STEP);
+    else
+        prefault_step(map);
+
     // Check if load factor is too high (≥ 50%)
-    if (map->length * 2 >= map->capacity)
-        resize(map);  // Double
+    if (map->length * 2 >= map->capacity) {
+        start_resize(map);  // Double - entries move over during the next operations
+        migrate_step(map, MIGRATE_STEP);
+    }
 
-    long long h = hash_str(key);
     unsigned idx = index_from_hash(h, map->capacity);
 
-    while (map->table[idx].key) {
-        if (strcmp(map->table[idx].key, key) == 0) {
+    while (map->table[idx].hash) {
+        if (map->table[idx].hash == h && strcmp(entry_key(&map->table[idx]), key) == 0) {
             map->table[idx].value = value;
             return;
         }
-        idx = (idx + 1) % map->capacity;
+        idx = (idx + 1) & (map->capacity - 1);
     }
 
-    map->table[idx].key = strdup(key);  // strdup makes a copy of the key string - string duplicate
+    // Not moved yet? Update it where it is, the migration will carry it over
+    if (map->old_table) {
+        long old = find_old_slot(map, key, h);
+        if (old >= 0) {
+            map->old_table[old].value = value;
+            return;
+        }
+    }
+
+    entry_store_key(map, &map->table[idx], key);  // copy of the key: inline if short, arena if long
     map->table[idx].value = value;
+    map->table[idx].hash = h;
     map->length++;
 }
 
-void* hash_map_get(hash_map_t* map, const char* key) {
-    long long h = hash_str(key);
-    unsigned idx = index_from_hash(h, map->capacity);
+void* hash_map_get_hashed(hash_map_t* map, const char* key, unsigned long long h) {
+    if (map->ctrl)
+        return swiss_get(map, key, h);
 
-    while (1) { //looks scary, but it is safe because we will always at least find an empty slot
-        if (!map->table[idx].key)
-            return NULL;
-        if (strcmp(map->table[idx].key, key) == 0)
-            return map->table[idx].value;
-        idx = (idx + 1) % map->capacity;
+    long idx = find_slot(map->table, map->capacity, key, h);
+    if (idx >= 0)
+        return map->table[idx].value;
+
+    if (map->old_table) {
+        idx = find_old_slot(map, key, h);
+        if (idx >= 0)
+            return map->old_table[idx].value;
     }
+    return NULL;
 }
 
-void hash_map_delete(hash_map_t* map, const char* key) {
-    long long h = hash_str(key);
-    unsigned idx = index_from_hash(h, map->capacity);
+/* =====================================================================
+ * hash_map_delete: Removes key using backward-shift deletion
+ * =====================================================================
+ * With linear probing we can't just empty the slot: a key that was pushed
+ * past it during insertion would become unreachable (get stops at the
+ * first empty slot). So after emptying slot i we walk the rest of the
+ * cluster and pull back every entry whose home slot is "at or before" i,
+ * leaving the table exactly as if the deleted key was never inserted.
+ *
+ * The home slot comes from the stored hash - again no string work.
+ * (Keys still waiting in the old table get a tombstone instead, see above.)
+ * ===================================================================== */
+void hash_map_delete_hashed(hash_map_t* map, const char* key, unsigned long long h) {
+    if (map->ctrl) {
+        swiss_delete(map, key, h);
+        return;
+    }
 
+    if (map->old_table)
+        migrate_step(map, MIGRATE_STEP);
+
+    long found = find_slot(map->table, map->capacity, key, h);
+    if (found < 0) {
+        if (map->old_table) {
+            long old = find_old_slot(map, key, h);
+            if (old >= 0) {
+                entry_release_key(map, &map->old_table[old]);
+                map->old_table[old].hash = TOMBSTONE_HASH;
+                map->old_length--;
+                map->length--;
+            }
+        }
+        return;
+    }
+
+    unsigned mask = map->capacity - 1;
+    unsigned i = (unsigned)found;
+    entry_release_key(map, &map->table[i]);
+
+    unsigned j = i;
     while (1) {
-        if (!map->table[idx].key)
-            return;
-        if (strcmp(map->table[idx].key, key) == 0) {
-            free(map->table[idx].key);
-            map->table[idx].key = NULL;
-            map->table[idx].value = NULL;
-            map->length--;
-            return;
+        j = (j + 1) & mask;
+        if (!map->table[j].hash)
+            break;
+        unsigned home = index_from_hash(map->table[j].hash, map->capacity);
+        // Entry j may move into the hole only if its home is not in (i, j]
+        if (((j - home) & mask) >= ((j - i) & mask)) {
+            map->table[i] = map->table[j];
+            i = j;
         }
-        // This slot is taken but not our key, try next
-        idx = (idx + 1) % map->capacity;
     }
+
+    memset(&map->table[i], 0, sizeof(hash_entry_t));
+    map->length--;
 }
 
-void free_hash_map(hash_map_t* map) {
+/* =====================================================================
+ * hash_map_foreach: Calls fn(key, value, ctx) once for every entry
+ * =====================================================================
+ * Order is the table order (i.e. random). Don't put/delete inside fn.
+ * Works for both backends: empty and deleted slots have hash 0 or 1.
+ * ===================================================================== */
+void hash_map_foreach(hash_map_t* map, void (*fn)(const char* key, void* value, void* ctx), void* ctx) {
     for (unsigned i = 0; i < map->capacity; ++i)
-        if (map->table[i].key)
-            free(map->table[i].key);
+        if (map->table[i].hash > TOMBSTONE_HASH)
+            fn(entry_key(&map->table[i]), map->table[i].value, ctx);
 
+    if (map->old_table)
+        for (unsigned i = map->migrate_pos; i < map->old_capacity; ++i)
+            if (map->old_table[i].hash > TOMBSTONE_HASH)
+                fn(entry_key(&map->old_table[i]), map->old_table[i].value, ctx);
+}
+
+/* =====================================================================
+ * free_hash_map: Releases the table and ALL keys at once
+ * =====================================================================
+ * Short keys are inside the table, long keys are in the arena blocks,
+ * so there is no per-key free() loop anymore.
+ * ===================================================================== */
+void free_hash_map(hash_map_t* map) {
+    key_arena_free(&map->keys);
     free(map->table);
+    free(map->old_table);
+    free(map->next_table);
+    free(map->ctrl);
     free(map);
 }
\ No newline at end of file
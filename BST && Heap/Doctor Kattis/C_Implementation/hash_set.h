@@ -1,28 +1,57 @@
 #ifndef C_IMPLEMENTATION_HASH_SET_H
 #define C_IMPLEMENTATION_HASH_SET_H
 
+#include "key_arena.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 #define DEFAULT_HASH_SET_CAPACITY (1 << 10)
+#define HASH_KEY_INLINE 23 // keys up to this many chars are stored inside the entry
 
     typedef struct {
-        char* key;
+        unsigned long long hash; // hash_str(key), kept so resize and probes never re-hash; 0 = empty, 1 = tombstone
         void* value;
+        union {
+            char inline_key[HASH_KEY_INLINE + 1]; // short keys, '\0' terminated
+            char* arena_key;                      // long keys, allocated from hash_map_t.keys
+        } key;
     } hash_entry_t;
 
     typedef struct {
         unsigned capacity;
         unsigned length;
         hash_entry_t* table;
+        unsigned char* ctrl;   // Swiss table control bytes, NULL for plain linear probing
+        unsigned tombstones;   // Swiss table only: DELETED control bytes
+        key_arena_t keys;      // storage for keys longer than HASH_KEY_INLINE
+
+        // Incremental resize (linear probing only): the previous table while
+        // its entries are being moved over, slots [0, migrate_pos) are done
+        hash_entry_t* old_table;
+        unsigned old_capacity;
+        unsigned old_length;   // entries still in old_table (also counted in length)
+        unsigned migrate_pos;
+
+        // The table the NEXT resize will switch to, allocated early and
+        // faulted in a little at a time (linear probing only, see hash_set.cpp)
+        hash_entry_t* next_table;
+        unsigned long long prefault_done;   // bytes of next_table touched so far
+        unsigned long long prefault_credit; // bytes earned by puts, touched in batches
     } hash_map_t;
 
     hash_map_t* init_hash_map();
+    hash_map_t* init_swiss_hash_map(); // same API, probes 16 slots per step (swiss_table.cpp)
     void* hash_map_get(hash_map_t* map, const char* key);
     void hash_map_put(hash_map_t* map, const char* key, void* value);
     void hash_map_delete(hash_map_t* map, const char* key);
-    long long hash_str(const char* str);
+    void* hash_map_get_hashed(hash_map_t* map, const char* key, unsigned long long h);
+    void hash_map_put_hashed(hash_map_t* map, const char* key, unsigned long long h, void* value);
+    void hash_map_delete_hashed(hash_map_t* map, const char* key, unsigned long long h);
+    void hash_map_reserve(hash_map_t* map, unsigned n); // room for n keys without resizing (empty map only)
+    void hash_map_foreach(hash_map_t* map, void (*fn)(const char* key, void* value, void* ctx), void* ctx);
+    unsigned long long hash_str(const char* str);
     void free_hash_map(hash_map_t* map);
 
 #ifdef __cplusplus
@@ -0,0 +1,97 @@
+/* =====================================================================
+ * KEY ARENA - bump allocator for the long keys of hash_map_t
+ * =====================================================================
+ *
+ * strdup() = one malloc per key. Every malloc has its own header (16 bytes
+ * on most systems), ends up wherever the allocator finds room, and has
+ * to be freed one by one at the end.
+ *
+ * An arena grabs big blocks (64 KB) and hands out pieces of them by just
+ * moving a pointer forward ("bump"). Keys stored one after the other are
+ * next to each other in memory, and freeing the arena is one free() per
+ * block instead of one per key.
+ *
+ * RECYCLING:
+ * A bump allocator can't give back a single piece, so released keys go
+ * into a free list for their size class (rounded up to 8 bytes) and the
+ * next key of the same class reuses the spot. The first 8 bytes of a
+ * released chunk hold the "next" pointer of the list.
+ *
+ * Every chunk starts with its size so release knows the class:
+ *   [ size_t size | key bytes ... \0 | padding ]
+ * ===================================================================== */
+
+#include "key_arena.h"
+#include <stdlib.h>
+#include <string.h>
+
+static size_t round_up8(size_t n) { return (n + 7) & ~(size_t)7; }
+
+void key_arena_init(key_arena_t* arena) {
+    memset(arena, 0, sizeof(*arena));
+}
+
+static char* bump(key_arena_t* arena, size_t bytes) {
+    key_arena_block* b = arena->head;
+    if (!b || b->used + bytes > b->size) {
+        size_t size = bytes > KEY_ARENA_BLOCK_SIZE ? bytes : KEY_ARENA_BLOCK_SIZE;
+        b = (key_arena_block*)malloc(sizeof(key_arena_block) + size);
+        b->used = 0;
+        b->size = size;
+        b->next = arena->head;  // new block goes in front, the old one keeps its unused tail
+        arena->head = b;
+    }
+    char* p = b->data + b->used;
+    b->used += bytes;
+    return p;
+}
+
+/* =====================================================================
+ * key_arena_strdup: Copies len bytes of str (+ '\0') into the arena
+ * ===================================================================== */
+char* key_arena_strdup(key_arena_t* arena, const char* str, size_t len) {
+    size_t chunk = round_up8(sizeof(size_t) + len + 1);
+    size_t cls = chunk / 8 - 1;
+    char* p;
+
+    if (cls < KEY_ARENA_SIZE_CLASSES && arena->free_lists[cls]) {
+        p = (char*)arena->free_lists[cls];
+        memcpy(&arena->free_lists[cls], p, sizeof(void*));  // pop
+    } else {
+        p = bump(arena, chunk);
+    }
+
+    memcpy(p, &chunk, sizeof(size_t));
+    char* s = p + sizeof(size_t);
+    memcpy(s, str, len);
+    s[len] = '\0';
+    return s;
+}
+
+/* =====================================================================
+ * key_arena_release: Gives a key back for reuse by a key of the same size
+ * =====================================================================
+ * Chunks bigger than the largest class stay where they are until
+ * key_arena_free - patient names that long are rare.
+ * ===================================================================== */
+void key_arena_release(key_arena_t* arena, char* str) {
+    char* p = str - sizeof(size_t);
+    size_t chunk;
+    memcpy(&chunk, p, sizeof(size_t));
+    size_t cls = chunk / 8 - 1;
+    if (cls >= KEY_ARENA_SIZE_CLASSES)
+        return;
+
+    memcpy(p, &arena->free_lists[cls], sizeof(void*));  // push
+    arena->free_lists[cls] = p;
+}
+
+void key_arena_free(key_arena_t* arena) {
+    key_arena_block* b = arena->head;
+    while (b) {
+        key_arena_block* next = b->next;
+        free(b);
+        b = next;
+    }
+    key_arena_init(arena);
+}
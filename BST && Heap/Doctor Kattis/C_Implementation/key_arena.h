@@ -0,0 +1,35 @@
+#ifndef C_IMPLEMENTATION_KEY_ARENA_H
+#define C_IMPLEMENTATION_KEY_ARENA_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define KEY_ARENA_BLOCK_SIZE (64 * 1024)
+#define KEY_ARENA_SIZE_CLASSES 32 // recycled sizes: 8, 16, ..., 256 bytes
+
+    typedef struct key_arena_block {
+        struct key_arena_block* next;
+        size_t used;
+        size_t size;
+        char data[];
+    } key_arena_block;
+
+    // Bump allocator for key strings: one malloc per 64 KB instead of one per key
+    typedef struct {
+        key_arena_block* head;
+        void* free_lists[KEY_ARENA_SIZE_CLASSES]; // released chunks, by size class
+    } key_arena_t;
+
+    void key_arena_init(key_arena_t* arena);
+    char* key_arena_strdup(key_arena_t* arena, const char* str, size_t len);
+    void key_arena_release(key_arena_t* arena, char* str);
+    void key_arena_free(key_arena_t* arena);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
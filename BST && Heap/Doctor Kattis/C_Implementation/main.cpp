@@ -1,78 +1,101 @@
-#include <iostream>
-#include <string>
-#include "rbtree.h"
-#include "hash_set.h"
+#include "triage.h"
+#include "sharded_triage.h"
+#include "../../../FastIO/fast_io.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 
 using namespace std;
 
-int compare_patients(const Patient* a, const Patient* b);
+// ./C_Implementation [--backend buckets|rbtree|rbpool|pairing] [--threads N]
+// Same output for all of them. --threads N runs N worker shards (sharded_triage.cpp)
+//
+// Besides the four Kattis commands:
+//   4 K      the next K patients, one per line, nobody is removed
+//   5 NAME   NAME's place in line (1 = next), 0 if NAME isn't waiting
+static int parse_backend(int argc, char** argv, triage_mode_t* mode) {
+    // Buckets while severities are small, the red-black tree otherwise
+    *mode = TRIAGE_BUCKETS;
+    for (int i = 1; i < argc; i++)
+        if (strcmp(argv[i], "--backend") == 0)
+            return i + 1 < argc ? triage_mode_from_name(argv[i + 1], mode) : -1;
+    return 0;
+}
 
-class Patient {
-public:
-    int severity;
-    int arrival;
-    string name;
-    Patient() = default;
-    Patient(string n, int s, int a) : severity(s), arrival(a), name(move(n)) {}
-};
+static unsigned parse_threads(int argc, char** argv) {
+    for (int i = 1; i + 1 < argc; i++)
+        if (strcmp(argv[i], "--threads") == 0)
+            return (unsigned)atoi(argv[i + 1]);
+    return 0;  // no workers, everything on this thread
+}
 
-int compare_patients(const Patient* a, const Patient* b) {
-    if (a->severity != b->severity)
-        return b->severity - a->severity;  // higher severity first
-    return a->arrival - b->arrival;
+// command 4 prints every patient it is handed
+static void print_patient(Patient* p, void* out) {
+    ((FastWriter*)out)->write(p->name);
+    ((FastWriter*)out)->put('\n');
 }
 
-int main() {
-    ios::sync_with_stdio(false);
-    cin.tie(nullptr);
+int main(int argc, char** argv) {
+    triage_mode_t mode;
+    if (parse_backend(argc, argv, &mode) != 0) {
+        fprintf(stderr, "usage: %s [--backend buckets|rbtree|rbpool|pairing] [--threads N]\n", argv[0]);
+        return 1;
+    }
+    FastReader in;
+    FastWriter out;
 
-    RBTree* patients = rbtree_create(compare_patients);
-    hash_map_t* dict = init_hash_map();
-    int t, arrival = 0;
-    cin >> t;
+    unsigned threads = parse_threads(argc, argv);
+    triage_t* clinic = threads ? NULL : triage_create(mode);
+    sharded_triage_t* sharded = threads ? sharded_triage_create(threads, mode) : NULL;
+    int t = in.readInt();
 
     while (t--) {
-        int cmd;
-        cin >> cmd;
-        string name;
+        int cmd = in.readInt();
         if (cmd == 0) {
-            int sev;
-            cin >> name >> sev;
-            Patient* p = new Patient(name, sev, arrival++);
-            rbtree_insert(patients, p);
-            hash_map_put(dict, name.c_str(), p);
+            const char* name = in.readCString();
+            int sev = in.readInt();
+            if (sharded) sharded_triage_admit(sharded, name, sev);
+            else triage_admit(clinic, name, sev);
         }
         else if (cmd == 1) {
-            int inc;
-            cin >> name >> inc;
-            Patient* p = (Patient*)hash_map_get(dict, name.c_str());
-            if (p) {
-                rbtree_delete(patients, p);
-                p->severity += inc;
-                rbtree_insert(patients, p);
-            }
+            const char* name = in.readCString();
+            int inc = in.readInt();
+            if (sharded) sharded_triage_bump(sharded, name, inc);
+            else triage_bump(clinic, name, inc);
         }
         else if (cmd == 2) {
-            cin >> name;
-            Patient* p = (Patient*)hash_map_get(dict, name.c_str());
-            if (p) {
-                rbtree_delete(patients, p);
-                hash_map_delete(dict, name.c_str());
-                delete p;
-            }
+            const char* name = in.readCString();
+            if (sharded) sharded_triage_discharge(sharded, name);
+            else triage_discharge(clinic, name);
         }
         else if (cmd == 3) {
-            if (rbtree_empty(patients)) {
-                cout << "The clinic is empty\n";
+            const char* next = sharded ? sharded_triage_next(sharded) : triage_next(clinic);
+            if (!next) {
+                out.write("The clinic is empty\n");
             } else {
-                Patient* p = rbtree_min(patients);
-                cout << p->name << "\n";
+                out.write(next);
+                out.put('\n');
             }
         }
+        else if (cmd == 4) {
+            int k = in.readInt();
+            bool empty = sharded ? sharded_triage_next(sharded) == NULL : triage_top(clinic) == NULL;
+            if (k > 0 && empty)
+                out.write("The clinic is empty\n");
+            else if (sharded)
+                sharded_triage_top_k(sharded, k, print_patient, &out);
+            else
+                triage_top_k(clinic, k, print_patient, &out);
+        }
+        else if (cmd == 5) {
+            const char* name = in.readCString();
+            out.writeInt(sharded ? sharded_triage_position(sharded, name) : triage_position(clinic, name));
+            out.put('\n');
+        }
     }
 
-    rbtree_free(patients);
-    free_hash_map(dict);
+    if (sharded) sharded_triage_free(sharded);
+    else triage_free(clinic);
     return 0;
 }
 
@@ -81,4 +104,4 @@ int main() {
 * https://github.com/TheAlgorithms/C/tree/master/data_structures
 * And this guy
 *  https://www.youtube.com/@MichaelSambol
-*/
\ No newline at end of file
+*/
@@ -0,0 +1,187 @@
+/* =====================================================================
+ * PAIRING HEAP IMPLEMENTATION
+ * =====================================================================
+ *
+ * A heap-ordered tree where a node can have any number of children:
+ * every node is "better" (compare < 0) than all of its children, so the
+ * root is the next patient. Children are kept in a linked list:
+ *
+ *        root
+ *         |  child
+ *         v
+ *         A  ->  B  ->  C        (sibling pointers)
+ *         |
+ *         D  ->  E
+ *
+ * THE ONLY REAL OPERATION - meld(a, b):
+ *   The better of the two roots stays on top and the other one becomes
+ *   its leftmost child. One compare, three pointer writes.
+ *
+ *   insert       - meld(root, node)                               O(1)
+ *   improve key  - cut node's subtree out, meld(root, node)        O(1) amortized*
+ *   delete       - cut node out, combine its children, meld back  O(log n) amortized
+ *   min          - root                                            O(1)
+ *
+ * (*) proven o(log n), in practice constant. This is why it fits our
+ * traffic: arrivals and severity bumps are the common commands, and
+ * those are exactly the cheap ones. A bump only makes a patient MORE
+ * urgent, so their subtree is still heap ordered and can be cut and
+ * melded with the root as it is.
+ *
+ * COMBINING CHILDREN - two-pass pairing:
+ *   pass 1 (left to right): meld children in pairs  (A,B) (C,D) (E)
+ *   pass 2 (right to left): meld each pair into the result
+ * This is what keeps the amortized bounds; melding them one by one
+ * could build a long chain.
+ * ===================================================================== */
+
+#include "pairing_heap.h"
+#include <stdlib.h>
+#include <queue>
+#include <vector>
+
+PairingHeap* pairing_heap_create(int (*cmp)(const Patient*, const Patient*)) {
+    PairingHeap* h = (PairingHeap*)malloc(sizeof(PairingHeap));
+    h->root = NULL;
+    h->compare = cmp;
+    return h;
+}
+
+// a and b are roots (no prev, no sibling). Returns the new root.
+static PairingNode* meld(PairingHeap* h, PairingNode* a, PairingNode* b) {
+    if (!a) return b;
+    if (!b) return a;
+    if (h->compare(b->data, a->data) < 0) {
+        PairingNode* t = a; a = b; b = t;
+    }
+    // b becomes the leftmost child of a
+    b->prev = a;
+    b->sibling = a->child;
+    if (a->child)
+        a->child->prev = b;
+    a->child = b;
+    return a;
+}
+
+/* =====================================================================
+ * combine_siblings: two-pass pairing of a sibling list into one tree
+ * =====================================================================
+ * Iterative, so a long list of children can't blow the stack.
+ * Pass 1 links the pair winners back together through 'prev', which
+ * turns them into a list we can walk backwards in pass 2.
+ * ===================================================================== */
+static PairingNode* combine_siblings(PairingHeap* h, PairingNode* first) {
+    PairingNode* last_pair = NULL;
+
+    while (first) {
+        PairingNode* a = first;
+        PairingNode* b = a->sibling;
+        first = b ? b->sibling : NULL;
+
+        a->prev = a->sibling = NULL;
+        if (b) b->prev = b->sibling = NULL;
+
+        PairingNode* winner = meld(h, a, b);
+        winner->prev = last_pair;  // temporary back link for pass 2
+        last_pair = winner;
+    }
+
+    PairingNode* result = NULL;
+    while (last_pair) {
+        PairingNode* before = last_pair->prev;
+        last_pair->prev = NULL;
+        result = meld(h, last_pair, result);
+        last_pair = before;
+    }
+    return result;
+}
+
+// Detaches node (with its whole subtree) from its parent / siblings
+static void cut(PairingHeap* h, PairingNode* node) {
+    if (node == h->root)
+        return;
+    if (node->prev->child == node)
+        node->prev->child = node->sibling;  // node was the leftmost child
+    else
+        node->prev->sibling = node->sibling;
+    if (node->sibling)
+        node->sibling->prev = node->prev;
+    node->prev = node->sibling = NULL;
+}
+
+void pairing_heap_insert(PairingHeap* heap, PairingNode* node) {
+    node->child = node->sibling = node->prev = NULL;
+    heap->root = meld(heap, heap->root, node);
+}
+
+/* =====================================================================
+ * pairing_heap_improve: call AFTER the node became more urgent
+ * =====================================================================
+ * Its children are still worse than it, so the subtree stays valid;
+ * only the link to its parent may now be wrong. Cut it and meld.
+ * ===================================================================== */
+void pairing_heap_improve(PairingHeap* heap, PairingNode* node) {
+    if (node == heap->root)
+        return;
+    cut(heap, node);
+    heap->root = meld(heap, heap->root, node);
+}
+
+void pairing_heap_delete(PairingHeap* heap, PairingNode* node) {
+    if (node == heap->root) {
+        heap->root = combine_siblings(heap, node->child);
+    } else {
+        cut(heap, node);
+        heap->root = meld(heap, heap->root, combine_siblings(heap, node->child));
+    }
+    node->child = node->sibling = node->prev = NULL;
+}
+
+Patient* pairing_heap_min(PairingHeap* heap) {
+    return heap->root ? heap->root->data : NULL;
+}
+
+int pairing_heap_empty(PairingHeap* heap) {
+    return heap->root == NULL;
+}
+
+/* =====================================================================
+ * Looking without removing
+ * =====================================================================
+ * Heap order is all we have: a node beats all of its children, but
+ * says nothing about its siblings.
+ *
+ * TOP K - best first: the root is first; after taking a node, its
+ *   children become candidates. Right after a run of inserts the root has
+ *   one child per insert, and walking them on every query made "top k"
+ *   O(n). So each node taken first gets its children paired up with
+ *   combine_siblings - the same work a pop does, so the same amortized
+ *   O(log n) - and hands down a single child. Heap order stays as it
+ *   was, the next query finds the children already paired, and at most
+ *   k + 1 candidates are ever waiting: O(k log n) amortized.
+ *
+ * Positions need more than heap order; triage.cpp keeps a rank index.
+ * ===================================================================== */
+void pairing_heap_top_k(PairingHeap* heap, int k, void (*fn)(Patient* p, void* ctx), void* ctx) {
+    auto later = [heap](PairingNode* a, PairingNode* b) { return heap->compare(b->data, a->data) < 0; };
+    std::priority_queue<PairingNode*, std::vector<PairingNode*>, decltype(later)> candidates(later);
+
+    if (heap->root)
+        candidates.push(heap->root);
+    while (!candidates.empty() && k > 0) {
+        PairingNode* n = candidates.top();
+        candidates.pop();
+        fn(n->data, ctx);
+        k--;
+        if (n->child && n->child->sibling) {
+            n->child = combine_siblings(heap, n->child);
+            n->child->prev = n;
+        }
+        if (n->child)
+            candidates.push(n->child);
+    }
+}
+
+void pairing_heap_free(PairingHeap* heap) {
+    free(heap);  // the nodes belong to the patients
+}
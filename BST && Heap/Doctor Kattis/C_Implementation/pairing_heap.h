@@ -0,0 +1,44 @@
+#ifndef C_IMPLEMENTATION_PAIRING_HEAP_H
+#define C_IMPLEMENTATION_PAIRING_HEAP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    typedef struct Patient Patient; // forward declaration for comparison
+
+    // Handle: lives inside the Patient, so no allocation per insert
+    typedef struct PairingNode {
+        Patient* data;
+        struct PairingNode* child;   // leftmost child
+        struct PairingNode* sibling; // next sibling to the right
+        struct PairingNode* prev;    // left sibling, or the parent for a leftmost child
+    } PairingNode;
+
+    typedef struct PairingHeap {
+        PairingNode* root;
+        int (*compare)(const Patient*, const Patient*);
+    } PairingHeap;
+
+    PairingHeap* pairing_heap_create(int (*cmp)(const Patient*, const Patient*));
+
+    void pairing_heap_insert(PairingHeap* heap, PairingNode* node);
+
+    void pairing_heap_improve(PairingHeap* heap, PairingNode* node); // node's key moved towards the top
+
+    void pairing_heap_delete(PairingHeap* heap, PairingNode* node);
+
+    Patient* pairing_heap_min(PairingHeap* heap);
+
+    int pairing_heap_empty(PairingHeap* heap);
+
+    // Calls fn on the next k patients in order, without removing them
+    void pairing_heap_top_k(PairingHeap* heap, int k, void (*fn)(Patient* p, void* ctx), void* ctx);
+
+    void pairing_heap_free(PairingHeap* heap);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
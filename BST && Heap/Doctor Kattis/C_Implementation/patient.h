@@ -0,0 +1,49 @@
+#ifndef C_IMPLEMENTATION_PATIENT_H
+#define C_IMPLEMENTATION_PATIENT_H
+
+#include <cstdint>
+#include <string>
+#include "bucket_queue.h"
+#include "pairing_heap.h"
+#include "rbtree_template.h"
+#include "rbtree_pool.h"
+
+// What the red-black tree stores: higher severity first, then earlier arrival,
+// packed into one integer so a compare is one instruction and never touches the Patient
+struct QueueEntry {
+    uint64_t key;
+    Patient* patient;
+};
+
+inline uint64_t priority_key(int severity, int arrival) {
+    uint32_t sev = ~((uint32_t)severity ^ 0x80000000u);  // flip the order, keep negatives in place
+    return ((uint64_t)sev << 32) | (uint32_t)arrival;
+}
+
+struct QueueOrder {
+    bool operator()(const QueueEntry& a, const QueueEntry& b) const { return a.key < b.key; }
+};
+
+typedef dsa::RBTree<QueueEntry, QueueOrder, true> PatientTree; // ranked: positions in O(log n)
+typedef dsa::PooledRBTree<QueueEntry, QueueOrder, true> PatientPoolTree; // ranked too
+
+class Patient {
+public:
+    int severity;
+    int arrival;
+    std::string name;
+    BucketNode link; // this patient's entry in the bucket queue
+    PairingNode node; // ... and in the pairing heap
+    PatientTree::Node* tree_node = NULL; // ... and in the red-black tree
+    uint32_t pool_node = 0;              // ... or in the pooled one (an index)
+
+    Patient() = default;
+    Patient(std::string n, int s, int a) : severity(s), arrival(a), name(std::move(n)) {
+        link = {this, s, a, -1};
+        node = {this, NULL, NULL, NULL};
+    }
+};
+
+int compare_patients(const Patient* a, const Patient* b);
+
+#endif
@@ -0,0 +1,178 @@
+#include "position_test.h"
+#include "sharded_triage.h"
+
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+/* =====================================================================
+ * Brute force reference for commands 3, 4 and 5
+ * =====================================================================
+ * The reference is just a map name -> (severity, arrival). Its answers
+ * are computed the slow, obviously right way:
+ *   position(X) = 1 + number of waiting patients whose priority_key is
+ *                 smaller than X's   (0 if X isn't waiting)
+ *   next / top k = sort everybody by priority_key
+ * and compared with the clinic after every operation: the position of a
+ * few random names (waiting or not), "next", and every so often the
+ * position of EVERY waiting patient plus the top 5.
+ *
+ * The operations cover what changes an order: admits (also of names
+ * that are already waiting), bumps both ways, discharges, and a few
+ * severities outside the bucket range, so TRIAGE_BUCKETS switches to the
+ * tree midway. The first position query also builds the rank index of
+ * BUCKETS / PAIRING, so everything after it checks that it is kept in
+ * sync. bucket_range keeps every severity in 0..99 (bumps are clipped)
+ * and uses fewer names, so the buckets themselves are tested the whole
+ * way through, with many re-admits of waiting names.
+ * Same seed, same test.
+ * ===================================================================== */
+
+typedef std::map<std::string, std::pair<int, int>> reference_t; // name -> severity, arrival
+
+// One interface over triage_t and sharded_triage_t
+struct Clinic {
+    triage_t* single = NULL;
+    sharded_triage_t* sharded = NULL;
+
+    void admit(const char* name, int severity) {
+        if (sharded) sharded_triage_admit(sharded, name, severity);
+        else triage_admit(single, name, severity);
+    }
+    void bump(const char* name, int increase) {
+        if (sharded) sharded_triage_bump(sharded, name, increase);
+        else triage_bump(single, name, increase);
+    }
+    void discharge(const char* name) {
+        if (sharded) sharded_triage_discharge(sharded, name);
+        else triage_discharge(single, name);
+    }
+    const char* next() { return sharded ? sharded_triage_next(sharded) : triage_next(single); }
+    int position(const char* name) {
+        return sharded ? sharded_triage_position(sharded, name) : triage_position(single, name);
+    }
+    void top_k(int k, std::vector<std::string>& out) {
+        auto collect = [](Patient* p, void* ctx) { ((std::vector<std::string>*)ctx)->push_back(p->name); };
+        if (sharded) sharded_triage_top_k(sharded, k, collect, &out);
+        else triage_top_k(single, k, collect, &out);
+    }
+};
+
+static std::vector<std::string> reference_order(const reference_t& ref) {
+    std::vector<std::pair<uint64_t, std::string>> all;
+    for (const auto& [name, sa] : ref)
+        all.push_back({priority_key(sa.first, sa.second), name});
+    std::sort(all.begin(), all.end());
+    std::vector<std::string> order;
+    for (auto& e : all)
+        order.push_back(e.second);
+    return order;
+}
+
+static int reference_position(const reference_t& ref, const std::string& name) {
+    auto it = ref.find(name);
+    if (it == ref.end())
+        return 0;
+    uint64_t key = priority_key(it->second.first, it->second.second);
+    int ahead = 0;
+    for (const auto& [other, sa] : ref)
+        ahead += priority_key(sa.first, sa.second) < key;
+    return ahead + 1;
+}
+
+std::string run_position_generated_test(triage_mode_t mode, unsigned threads, int n, unsigned seed,
+                                        bool bucket_range) {
+    std::cout << "[POSITION-TEST] START mode=" << mode << " threads=" << threads << " n=" << n
+              << " seed=" << seed << " bucket_range=" << bucket_range << std::endl;
+
+    Clinic clinic;
+    if (threads) clinic.sharded = sharded_triage_create(threads, mode);
+    else clinic.single = triage_create(mode);
+    reference_t ref;
+    int arrival = 0;
+    std::mt19937 rng(seed);
+
+    std::vector<std::string> names;
+    for (int i = 0; i < std::max(8, n / (bucket_range ? 100 : 10)); i++)
+        names.push_back("p" + std::to_string(i));
+
+    std::string result;
+    auto fail = [&](int step, const std::string& why) {
+        std::ostringstream oss;
+        oss << "FAIL: " << why << " | step=" << step << " | waiting=" << ref.size() << " | mode=" << mode
+            << " | threads=" << threads << " | n=" << n << " | seed=" << seed << " | bucket_range=" << bucket_range;
+        return oss.str();
+    };
+
+    for (int step = 0; step < n && result.empty(); step++) {
+        const std::string& name = names[rng() % names.size()];
+        unsigned op = rng() % 10;
+        if (op < 4) {
+            // mostly bucket sized severities, now and then one that isn't
+            bool outside = !bucket_range && rng() % 200 == 0;
+            int severity = outside ? (int)(rng() % 2000000) - 1000000 : (int)(rng() % 100);
+            clinic.admit(name.c_str(), severity);
+            ref[name] = {severity, arrival++};
+        } else if (op < 7) {
+            int increase = (int)(rng() % 61) - 20;
+            auto it = ref.find(name);
+            if (bucket_range && it != ref.end())
+                increase = std::clamp(increase, -it->second.first, 99 - it->second.first);
+            clinic.bump(name.c_str(), increase);
+            if (it != ref.end())
+                it->second.first += increase;
+        } else {
+            clinic.discharge(name.c_str());
+            ref.erase(name);
+        }
+
+        for (int q = 0; q < 3 && result.empty(); q++) {
+            const std::string& asked = names[rng() % names.size()];
+            int got = clinic.position(asked.c_str()), want = reference_position(ref, asked);
+            if (got != want)
+                result = fail(step, "position(" + asked + ") = " + std::to_string(got) + ", brute force says " +
+                                        std::to_string(want));
+        }
+        if (!result.empty())
+            break;
+
+        const std::string* first = NULL;
+        uint64_t first_key = 0;
+        for (const auto& [waiting, sa] : ref)
+            if (!first || priority_key(sa.first, sa.second) < first_key)
+                first = &waiting, first_key = priority_key(sa.first, sa.second);
+        const char* next = clinic.next();
+        if ((next == NULL) != (first == NULL) || (next && *first != next)) {
+            result = fail(step, "next patient differs");
+            break;
+        }
+
+        if (step % 250 == 249) {
+            std::vector<std::string> order = reference_order(ref);
+            for (size_t i = 0; i < order.size() && result.empty(); i++)
+                if (clinic.position(order[i].c_str()) != (int)i + 1)
+                    result = fail(step, "full scan: position(" + order[i] + ") != " + std::to_string(i + 1));
+            std::vector<std::string> top;
+            clinic.top_k(5, top);
+            order.resize(std::min<size_t>(order.size(), 5));
+            if (result.empty() && top != order)
+                result = fail(step, "top 5 differs");
+        }
+    }
+
+    if (result.empty() && bucket_range && clinic.single && clinic.single->mode != mode)
+        result = fail(n, "left its mode although every severity fits the buckets");
+    if (clinic.sharded) sharded_triage_free(clinic.sharded);
+    else triage_free(clinic.single);
+    if (!result.empty())
+        return result;
+
+    std::ostringstream oss;
+    oss << "PASS: " << n << " operations | mode=" << mode << " | threads=" << threads << " | seed=" << seed
+        << " | bucket_range=" << bucket_range;
+    return oss.str();
+}
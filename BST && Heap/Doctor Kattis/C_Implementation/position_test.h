@@ -0,0 +1,14 @@
+#ifndef C_IMPLEMENTATION_POSITION_TEST_H
+#define C_IMPLEMENTATION_POSITION_TEST_H
+
+#include <string>
+#include "triage.h"
+
+// Random admits / bumps / discharges on a triage_t, every position,
+// "next" and top k answer checked against a brute force count.
+// threads > 0 runs the same on a sharded_triage_t, bucket_range = only
+// severities the bucket queue holds. "PASS ..." or "FAIL: ..."
+std::string run_position_generated_test(triage_mode_t mode, unsigned threads, int n, unsigned seed = 123456789u,
+                                        bool bucket_range = false);
+
+#endif
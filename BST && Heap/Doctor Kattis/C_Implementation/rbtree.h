@@ -7,18 +7,7 @@ extern "C" {
 
     typedef struct Patient Patient; // forward declaration for comparison
 
-    typedef struct RBNode {
-        Patient* data;
-        struct RBNode* parent;
-        struct RBNode* left;
-        struct RBNode* right;
-        int color; // 0 = black, 1 = red
-    } RBNode;
-
-    typedef struct RBTree {
-        RBNode* root;
-        int (*compare)(const Patient*, const Patient*);
-    } RBTree;
+    typedef struct RBTree RBTree;   // wraps dsa::RBTree<Patient*, ...>, see rbtree_template.h
 
     RBTree* rbtree_create(int (*cmp)(const Patient*, const Patient*));
 
@@ -36,4 +25,4 @@ extern "C" {
 }
 #endif
 
-#endif
\ No newline at end of file
+#endif
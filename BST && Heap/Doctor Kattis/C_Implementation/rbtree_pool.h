@@ -0,0 +1,606 @@
+#ifndef C_IMPLEMENTATION_RBTREE_POOL_H
+#define C_IMPLEMENTATION_RBTREE_POOL_H
+
+/* =====================================================================
+ * RED-BLACK TREE - ARRAY POOL VERSION
+ * =====================================================================
+ * Same tree as rbtree_template.h, but all nodes live in ONE growable
+ * array and link to each other by 32-bit index instead of by pointer:
+ *
+ *   nodes_: [ NIL | n1 | n2 | n3 | (free) | n5 | ... ]
+ *              0    1    2    3     4       5
+ *
+ *   node: parent<<1 | color (4 bytes) | left (4) | right (4) | T value
+ *         = 12 bytes + payload, versus 24 + payload with pointers
+ *
+ * WHY:
+ *   - half the link bytes and no malloc scatter: neighbours in the array
+ *     are often neighbours in the tree, more of it fits in cache
+ *   - no pointers inside: the whole tree is just the array, so it can be
+ *     copied with one memcpy (snapshots) or moved anywhere as is
+ *
+ * INDEX 0 IS THE NIL LEAF (always BLACK), like the sentinel in CLRS.
+ * Every missing child points at it, which also means fix_delete can
+ * read "x's parent" even when x is a leaf.
+ *
+ * FREE LIST: an erased node's index is pushed on a free list (chained
+ * through its 'left' field) and handed out again by the next insert.
+ * compact() is the maintenance call that squeezes the holes out.
+ *
+ * Handles are indices. They stay valid when the array grows (a pointer
+ * wouldn't), but compact() renumbers nodes and tells you about it.
+ *
+ * RANKED (Ranked = true): every node also keeps the size of its subtree,
+ * exactly as in rbtree_template.h, so rank() and count_less() are
+ * O(log n). 4 more bytes per node, so it is off by default.
+ * ===================================================================== */
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "rbtree_template.h"
+
+namespace dsa {
+
+template <class T, class Compare = std::less<T>, bool Ranked = false>
+class PooledRBTree {
+public:
+    static constexpr uint32_t NIL = 0;
+    typedef std::conditional_t<Ranked, uint32_t, NoSubtreeSize> SubtreeSize;
+
+    struct Node {
+        uint32_t parent_color; // parent index << 1 | color (1 = red, 0 = black)
+        uint32_t left;
+        uint32_t right;
+        [[no_unique_address]] SubtreeSize count; // nodes in this subtree (Ranked only, 0 for NIL)
+        T value;
+    };
+
+    explicit PooledRBTree(Compare comp = Compare()) : comp_(comp) {
+        nodes_.push_back(Node{NIL << 1, NIL, NIL, SubtreeSize(), T()});  // the NIL leaf
+    }
+
+    uint32_t insert(T value);       // returns the node index as a handle for erase()
+    void erase(uint32_t z);
+    bool erase(const T& value);
+    uint32_t find(const T& value) const;
+
+    uint32_t first() const { return leftmost_; }
+    const T* min() const { return leftmost_ != NIL ? &nodes_[leftmost_].value : nullptr; }
+    uint32_t next(uint32_t n) const; // in-order successor, NIL after the last
+
+    // Ranked only, O(log n): values before node n / values that compare less than value
+    size_t rank(uint32_t n) const;
+    size_t count_less(const T& value) const;
+
+    const T& value(uint32_t n) const { return nodes_[n].value; }
+    const Node& node(uint32_t n) const { return nodes_[n]; }
+    uint32_t root() const { return root_; }
+    const Compare& compare() const { return comp_; }
+
+    bool empty() const { return root_ == NIL; }
+    size_t size() const { return size_; }
+    size_t pool_size() const { return nodes_.size() - 1; }  // live + free slots
+    void clear();
+
+    // Maintenance: renumbers live nodes 1..size() in level order (top of the
+    // tree first, so the first levels of every search share cache lines),
+    // drops the free slots and calls moved(value, new_index) for each node.
+    template <class F>
+    void compact(F&& moved);
+    void compact() { compact([](const T&, uint32_t) {}); }
+
+private:
+    std::vector<Node> nodes_;
+    uint32_t root_ = NIL;
+    uint32_t leftmost_ = NIL;
+    uint32_t free_head_ = NIL;
+    size_t size_ = 0;
+    [[no_unique_address]] Compare comp_;
+
+    uint32_t parent(uint32_t n) const { return nodes_[n].parent_color >> 1; }
+    bool red(uint32_t n) const { return nodes_[n].parent_color & 1; }  // NIL is black
+    void set_red(uint32_t n) { nodes_[n].parent_color |= 1; }
+    void set_black(uint32_t n) { nodes_[n].parent_color &= ~1u; }
+    void set_color(uint32_t n, bool r) { nodes_[n].parent_color = (nodes_[n].parent_color & ~1u) | r; }
+    void set_parent(uint32_t n, uint32_t p) { nodes_[n].parent_color = (p << 1) | (nodes_[n].parent_color & 1); }
+
+    Node& at(uint32_t n) { return nodes_[n]; }
+
+    size_t count(uint32_t n) const {
+        if constexpr (Ranked)
+            return nodes_[n].count;  // NIL's stays 0
+        else
+            return 0;
+    }
+    void recount(uint32_t n) {
+        if constexpr (Ranked)
+            at(n).count = (uint32_t)(1 + count(at(n).left) + count(at(n).right));
+    }
+
+    uint32_t min_node(uint32_t n) const {
+        while (nodes_[n].left != NIL)
+            n = nodes_[n].left;
+        return n;
+    }
+
+    uint32_t alloc_node(T&& value, uint32_t parent);
+    void free_node(uint32_t n);
+
+    void replace_child(uint32_t parent, uint32_t old_child, uint32_t new_child) {
+        if (parent == NIL)
+            root_ = new_child;
+        else if (at(parent).left == old_child)
+            at(parent).left = new_child;
+        else
+            at(parent).right = new_child;
+    }
+
+    void transplant(uint32_t u, uint32_t v) {
+        replace_child(parent(u), u, v);
+        set_parent(v, parent(u));  // also on NIL: fix_delete reads it
+    }
+
+    void rotate_left(uint32_t x);
+    void rotate_right(uint32_t x);
+    void fix_insert(uint32_t z);
+    void fix_delete(uint32_t x);
+};
+
+template <class T, class Compare, bool Ranked>
+uint32_t PooledRBTree<T, Compare, Ranked>::alloc_node(T&& value, uint32_t parent) {
+    uint32_t n;
+    if (free_head_ != NIL) {
+        n = free_head_;  // recycle
+        free_head_ = at(n).left;
+        at(n) = Node{(parent << 1) | 1, NIL, NIL, SubtreeSize(), std::move(value)};
+    } else {
+        n = (uint32_t)nodes_.size();
+        nodes_.push_back(Node{(parent << 1) | 1, NIL, NIL, SubtreeSize(), std::move(value)});
+    }
+    if constexpr (Ranked)
+        at(n).count = 1;
+    return n;
+}
+
+template <class T, class Compare, bool Ranked>
+void PooledRBTree<T, Compare, Ranked>::free_node(uint32_t n) {
+    at(n).value = T();
+    at(n).left = free_head_;
+    free_head_ = n;
+}
+
+template <class T, class Compare, bool Ranked>
+void PooledRBTree<T, Compare, Ranked>::rotate_left(uint32_t x) {
+    uint32_t y = at(x).right;
+    at(x).right = at(y).left;
+    if (at(y).left != NIL)
+        set_parent(at(y).left, x);
+    set_parent(y, parent(x));
+    replace_child(parent(x), x, y);
+    at(y).left = x;
+    set_parent(x, y);
+    if constexpr (Ranked) {
+        at(y).count = at(x).count;  // y has x's old subtree, x is counted again
+        recount(x);
+    }
+}
+
+template <class T, class Compare, bool Ranked>
+void PooledRBTree<T, Compare, Ranked>::rotate_right(uint32_t x) {
+    uint32_t y = at(x).left;
+    at(x).left = at(y).right;
+    if (at(y).right != NIL)
+        set_parent(at(y).right, x);
+    set_parent(y, parent(x));
+    replace_child(parent(x), x, y);
+    at(y).right = x;
+    set_parent(x, y);
+    if constexpr (Ranked) {
+        at(y).count = at(x).count;
+        recount(x);
+    }
+}
+
+template <class T, class Compare, bool Ranked>
+uint32_t PooledRBTree<T, Compare, Ranked>::insert(T value) {
+    uint32_t p = NIL;
+    uint32_t x = root_;
+    bool go_left = false;
+    bool is_leftmost = true;
+
+    while (x != NIL) {
+        p = x;
+        if constexpr (Ranked)
+            at(x).count++;  // the new node ends up below every node on the way
+        go_left = comp_(value, at(x).value);
+        if (go_left) {
+            x = at(x).left;
+        } else {
+            x = at(x).right;  // equal values go right, after the old ones
+            is_leftmost = false;
+        }
+    }
+
+    // alloc_node may grow the vector, so no Node& is held across it
+    uint32_t z = alloc_node(std::move(value), p);
+    if (p == NIL)
+        root_ = z;
+    else if (go_left)
+        at(p).left = z;
+    else
+        at(p).right = z;
+    if (is_leftmost)
+        leftmost_ = z;
+    size_++;
+
+    fix_insert(z);
+    return z;
+}
+
+// Same cases as rbtree_template.h, with indices
+template <class T, class Compare, bool Ranked>
+void PooledRBTree<T, Compare, Ranked>::fix_insert(uint32_t z) {
+    while (red(parent(z))) {  // NIL is black, so this stops at the root
+        uint32_t p = parent(z);
+        uint32_t g = parent(p);
+
+        if (p == at(g).left) {
+            uint32_t y = at(g).right;
+            if (red(y)) {
+                set_black(p);
+                set_black(y);
+                set_red(g);
+                z = g;
+            } else {
+                if (z == at(p).right) {
+                    rotate_left(p);
+                    z = p;
+                    p = parent(z);
+                }
+                set_black(p);
+                set_red(g);
+                rotate_right(g);
+            }
+        } else {
+            uint32_t y = at(g).left;
+            if (red(y)) {
+                set_black(p);
+                set_black(y);
+                set_red(g);
+                z = g;
+            } else {
+                if (z == at(p).left) {
+                    rotate_right(p);
+                    z = p;
+                    p = parent(z);
+                }
+                set_black(p);
+                set_red(g);
+                rotate_left(g);
+            }
+        }
+    }
+    set_black(root_);
+}
+
+template <class T, class Compare, bool Ranked>
+void PooledRBTree<T, Compare, Ranked>::erase(uint32_t z) {
+    if (z == leftmost_)
+        leftmost_ = at(z).right != NIL ? min_node(at(z).right) : parent(z);
+
+    if constexpr (Ranked) {
+        // one node leaves from z's place, or from the successor's place when
+        // z has two children - every node above that place loses one
+        uint32_t from = at(z).left != NIL && at(z).right != NIL ? parent(min_node(at(z).right)) : parent(z);
+        for (; from != NIL; from = parent(from))
+            at(from).count--;
+    }
+
+    uint32_t x;
+    bool removed_black;
+
+    if (at(z).left == NIL) {
+        x = at(z).right;
+        removed_black = !red(z);
+        transplant(z, x);
+    } else if (at(z).right == NIL) {
+        x = at(z).left;
+        removed_black = !red(z);
+        transplant(z, x);
+    } else {
+        uint32_t y = min_node(at(z).right);
+        removed_black = !red(y);
+        x = at(y).right;
+
+        if (parent(y) == z) {
+            set_parent(x, y);  // x may be NIL, its parent still has to be right
+        } else {
+            transplant(y, x);
+            at(y).right = at(z).right;
+            set_parent(at(y).right, y);
+        }
+
+        transplant(z, y);
+        at(y).left = at(z).left;
+        set_parent(at(y).left, y);
+        set_color(y, red(z));
+        if constexpr (Ranked)
+            at(y).count = at(z).count;  // already one less, z was on the path above
+    }
+
+    size_--;
+    if (removed_black)
+        fix_delete(x);
+    set_parent(NIL, NIL);
+    set_black(NIL);
+    free_node(z);
+}
+
+template <class T, class Compare, bool Ranked>
+void PooledRBTree<T, Compare, Ranked>::fix_delete(uint32_t x) {
+    while (x != root_ && !red(x)) {
+        uint32_t p = parent(x);
+
+        if (x == at(p).left) {
+            uint32_t w = at(p).right;
+
+            if (red(w)) {
+                set_black(w);
+                set_red(p);
+                rotate_left(p);
+                w = at(p).right;
+            }
+            if (!red(at(w).left) && !red(at(w).right)) {
+                set_red(w);
+                x = p;
+            } else {
+                if (!red(at(w).right)) {
+                    set_black(at(w).left);
+                    set_red(w);
+                    rotate_right(w);
+                    w = at(p).right;
+                }
+                set_color(w, red(p));
+                set_black(p);
+                set_black(at(w).right);
+                rotate_left(p);
+                x = root_;
+            }
+        } else {
+            uint32_t w = at(p).left;
+
+            if (red(w)) {
+                set_black(w);
+                set_red(p);
+                rotate_right(p);
+                w = at(p).left;
+            }
+            if (!red(at(w).right) && !red(at(w).left)) {
+                set_red(w);
+                x = p;
+            } else {
+                if (!red(at(w).left)) {
+                    set_black(at(w).right);
+                    set_red(w);
+                    rotate_left(w);
+                    w = at(p).left;
+                }
+                set_color(w, red(p));
+                set_black(p);
+                set_black(at(w).left);
+                rotate_right(p);
+                x = root_;
+            }
+        }
+    }
+    set_black(x);
+}
+
+template <class T, class Compare, bool Ranked>
+bool PooledRBTree<T, Compare, Ranked>::erase(const T& value) {
+    uint32_t z = find(value);
+    if (z == NIL)
+        return false;
+    erase(z);
+    return true;
+}
+
+template <class T, class Compare, bool Ranked>
+uint32_t PooledRBTree<T, Compare, Ranked>::find(const T& value) const {
+    uint32_t x = root_;
+    while (x != NIL) {
+        if (comp_(value, nodes_[x].value))
+            x = nodes_[x].left;
+        else if (comp_(nodes_[x].value, value))
+            x = nodes_[x].right;
+        else
+            return x;
+    }
+    return NIL;
+}
+
+template <class T, class Compare, bool Ranked>
+uint32_t PooledRBTree<T, Compare, Ranked>::next(uint32_t n) const {
+    if (nodes_[n].right != NIL)
+        return min_node(nodes_[n].right);
+    uint32_t p = parent(n);
+    while (p != NIL && n == nodes_[p].right) {
+        n = p;
+        p = parent(p);
+    }
+    return p;
+}
+
+template <class T, class Compare, bool Ranked>
+size_t PooledRBTree<T, Compare, Ranked>::rank(uint32_t n) const {
+    static_assert(Ranked, "rank() needs PooledRBTree<T, Compare, true>");
+    size_t r = count(nodes_[n].left);
+    for (uint32_t p = parent(n); p != NIL; n = p, p = parent(p))
+        if (n == nodes_[p].right)
+            r += count(nodes_[p].left) + 1;  // p and its left side come before us
+    return r;
+}
+
+template <class T, class Compare, bool Ranked>
+size_t PooledRBTree<T, Compare, Ranked>::count_less(const T& value) const {
+    static_assert(Ranked, "count_less() needs PooledRBTree<T, Compare, true>");
+    size_t r = 0;
+    for (uint32_t x = root_; x != NIL; ) {
+        if (comp_(nodes_[x].value, value)) {
+            r += count(nodes_[x].left) + 1;
+            x = nodes_[x].right;
+        } else {
+            x = nodes_[x].left;
+        }
+    }
+    return r;
+}
+
+template <class T, class Compare, bool Ranked>
+void PooledRBTree<T, Compare, Ranked>::clear() {
+    nodes_.resize(1);
+    root_ = leftmost_ = free_head_ = NIL;
+    size_ = 0;
+}
+
+/* =====================================================================
+ * compact: rebuild the array with only the live nodes, in level order
+ * =====================================================================
+ * Walks the tree breadth first: the i-th node visited gets index i + 1.
+ * The shape and colors don't change, only the numbering, so it's O(n)
+ * with no compares. Afterwards there are no free slots and the array
+ * is exactly size() + 1 long.
+ * ===================================================================== */
+template <class T, class Compare, bool Ranked>
+template <class F>
+void PooledRBTree<T, Compare, Ranked>::compact(F&& moved) {
+    std::vector<Node> packed;
+    packed.reserve(size_ + 1);
+    packed.push_back(Node{NIL << 1, NIL, NIL, SubtreeSize(), T()});
+
+    std::vector<uint32_t> new_index(nodes_.size(), NIL);
+    if (root_ != NIL) {
+        // packed itself is the BFS queue: children are appended after their parent
+        packed.push_back(nodes_[root_]);
+        new_index[root_] = 1;
+        for (uint32_t i = 1; i < packed.size(); i++) {
+            uint32_t children[2] = {packed[i].left, packed[i].right};
+            for (uint32_t c : children) {
+                if (c == NIL) continue;
+                new_index[c] = (uint32_t)packed.size();
+                packed.push_back(nodes_[c]);
+            }
+        }
+        for (uint32_t i = 1; i < packed.size(); i++) {
+            Node& n = packed[i];
+            n.parent_color = (new_index[n.parent_color >> 1] << 1) | (n.parent_color & 1);
+            n.left = new_index[n.left];
+            n.right = new_index[n.right];
+            moved(n.value, i);
+        }
+    }
+
+    root_ = root_ != NIL ? 1 : NIL;
+    leftmost_ = new_index[leftmost_];
+    free_head_ = NIL;
+    nodes_.swap(packed);
+}
+
+/* =====================================================================
+ * rbtree_validate: checks the whole tree, returns NULL if it is fine or
+ * a message saying which rule is broken
+ * =====================================================================
+ * The five properties (see rbtree.cpp):
+ *   1. every node is RED or BLACK   - one bit, so we check what can go
+ *                                     wrong instead: parent/child links
+ *                                     agree and the values are in order
+ *                                     (each one inside the bounds its
+ *                                     ancestors set, like the intervals
+ *                                     of the B-Tree validator)
+ *   2. the root is BLACK
+ *   3. the NIL leaf is BLACK
+ *   4. a RED node has BLACK children
+ *   5. same number of BLACK nodes on every root-to-leaf path
+ * Plus the bookkeeping: size() and first() are right, and in a ranked
+ * tree every subtree size. O(n), for tests and debugging.
+ * ===================================================================== */
+template <class T, class Compare, bool Ranked>
+const char* rbtree_validate(const PooledRBTree<T, Compare, Ranked>& tree) {
+    typedef PooledRBTree<T, Compare, Ranked> Tree;
+    const uint32_t NIL = Tree::NIL;
+    auto parent = [&](uint32_t n) { return tree.node(n).parent_color >> 1; };
+    auto red = [&](uint32_t n) { return (tree.node(n).parent_color & 1) != 0; };
+    const Compare& comp = tree.compare();
+
+    if (red(NIL))
+        return "NIL leaf is red";
+    if constexpr (Ranked) {
+        if (tree.node(NIL).count != 0)
+            return "NIL leaf has a subtree size";
+    }
+    if (tree.root() == NIL)
+        return tree.size() == 0 && tree.first() == NIL ? nullptr : "empty tree has size or first";
+    if (red(tree.root()))
+        return "root is red";
+    if (parent(tree.root()) != NIL)
+        return "root has a parent";
+
+    const char* error = nullptr;
+    size_t count = 0;
+
+    // returns the black height of the subtree at n, -1 on error. Every
+    // value in it is >= the value of low and <= the one of high (NIL = no
+    // bound); equal values may sit on either side after a rotation
+    auto walk = [&](auto&& self, uint32_t n, uint32_t low, uint32_t high) -> int {
+        if (n == NIL)
+            return 1;
+        if (n > tree.pool_size()) {
+            error = "link outside the pool";
+            return -1;
+        }
+        size_t before = count++;
+        const auto& node = tree.node(n);
+        for (uint32_t c : {node.left, node.right}) {
+            if (c == NIL) continue;
+            if (parent(c) != n) { error = "child's parent link is wrong"; return -1; }
+            if (red(n) && red(c)) { error = "red node has a red child"; return -1; }
+        }
+        if (low != NIL && comp(node.value, tree.node(low).value)) {
+            error = "value is smaller than an ancestor it is right of";
+            return -1;
+        }
+        if (high != NIL && comp(tree.node(high).value, node.value)) {
+            error = "value is bigger than an ancestor it is left of";
+            return -1;
+        }
+        int lh = self(self, node.left, low, n);
+        if (lh < 0) return -1;
+        int rh = self(self, node.right, n, high);
+        if (rh < 0) return -1;
+        if (lh != rh) { error = "black heights differ"; return -1; }
+        if constexpr (Ranked) {
+            if (node.count != count - before) { error = "subtree size is wrong"; return -1; }
+        }
+        return lh + !red(n);
+    };
+
+    if (walk(walk, tree.root(), NIL, NIL) < 0)
+        return error;
+    if (count != tree.size())
+        return "size() doesn't match the node count";
+
+    uint32_t m = tree.root();
+    while (tree.node(m).left != NIL)
+        m = tree.node(m).left;
+    if (m != tree.first())
+        return "first() is not the leftmost node";
+    return nullptr;
+}
+
+} // namespace dsa
+
+#endif
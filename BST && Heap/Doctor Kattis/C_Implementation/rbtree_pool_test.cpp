@@ -0,0 +1,182 @@
+#include "rbtree_pool_test.h"
+#include "rbtree_pool.h"
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <set>
+#include <sstream>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/* =====================================================================
+ * Randomized test for dsa::PooledRBTree
+ * =====================================================================
+ * n operations, each one an insert or an erase by handle, in phases
+ * that fill the tree and drain it again. After every operation:
+ *   - rbtree_validate() (colors, black heights, links, size, first)
+ *   - an in-order walk equals the reference std::set
+ *   - every handle we hold still points at its own value
+ * What rbtree_validate can't see on its own is checked on the side:
+ *   - an insert after an erase reuses the freed slot (the free list),
+ *     so the pool doesn't grow
+ *   - compact() every so often: the moved() callback renumbers our
+ *     handles, and the pool is exactly size() afterwards
+ * Ranked trees: rank() of every node and count_less() of every value
+ * equal its place in the reference.
+ * Keys repeat (k, id): equal k go right, the id keeps values unique so
+ * moved() can tell them apart.
+ * And rbtree_validate itself, once per run: a value out of order with
+ * its grandparent but not with its parent has to be reported.
+ * Same seed, same test - a failure can be replayed.
+ * ===================================================================== */
+
+typedef std::pair<int, int> Value; // key, id
+
+template <class Tree>
+static std::string check(const Tree& tree, const std::set<Value>& reference,
+                         const std::vector<uint32_t>& handle, const std::vector<Value>& value_of) {
+    if (const char* error = dsa::rbtree_validate(tree))
+        return std::string("rbtree_validate: ") + error;
+    if (tree.size() != reference.size())
+        return "size differs from the reference";
+
+    uint32_t n = tree.first();
+    size_t i = 0;
+    for (const Value& v : reference) {
+        if (n == Tree::NIL || tree.value(n) != v)
+            return "in-order walk differs from the reference";
+        if constexpr (std::is_same_v<typename Tree::SubtreeSize, uint32_t>) {
+            if (tree.rank(n) != i || tree.count_less(v) != i)
+                return "rank() or count_less() differs from the place in the reference";
+        }
+        n = tree.next(n);
+        i++;
+    }
+    if (n != Tree::NIL)
+        return "in-order walk is longer than the reference";
+
+    for (size_t id = 0; id < handle.size(); id++)
+        if (handle[id] != Tree::NIL && tree.value(handle[id]) != value_of[id])
+            return "a handle points at another value";
+    return "";
+}
+
+// Orders ids by a key table the test can change behind the tree's back
+struct ByKey {
+    const std::vector<int>* key;
+    bool operator()(int a, int b) const { return (*key)[a] < (*key)[b]; }
+};
+
+// The largest node of the root's left subtree (a right child) made bigger
+// than the root: still in order with its parent and children, not with
+// the root. "" if rbtree_validate notices
+template <bool Ranked>
+static std::string check_validate_sees_ancestors() {
+    std::vector<int> key(64);
+    dsa::PooledRBTree<int, ByKey, Ranked> tree(ByKey{&key});
+    for (int id = 0; id < (int)key.size(); id++) {
+        key[id] = id * 2;
+        tree.insert(id);
+    }
+    if (const char* error = dsa::rbtree_validate(tree))
+        return std::string("rbtree_validate of a good tree: ") + error;
+
+    uint32_t root = tree.root(), m = tree.node(root).left;
+    if (tree.node(m).right == decltype(tree)::NIL)
+        return "test tree too small";
+    while (tree.node(m).right != decltype(tree)::NIL)
+        m = tree.node(m).right;
+    key[tree.value(m)] = key[tree.value(root)] + 1;
+    if (!dsa::rbtree_validate(tree))
+        return "rbtree_validate missed a value bigger than an ancestor it is left of";
+    return "";
+}
+
+template <bool Ranked>
+static std::string run_test(int n, unsigned seed) {
+    typedef dsa::PooledRBTree<Value, std::less<Value>, Ranked> Tree;
+    std::cout << "[RBPOOL-TEST] START n=" << n << " seed=" << seed << " ranked=" << Ranked << std::endl;
+
+    Tree tree;
+    std::set<Value> reference;
+    std::vector<uint32_t> handle;  // id -> node, NIL once erased
+    std::vector<Value> value_of;   // id -> value
+    std::vector<int> live;         // ids in the tree
+    std::mt19937 rng(seed);
+    int compacts = 0, reused = 0;
+
+    auto fail = [&](int step, const char* op, const std::string& why) {
+        std::ostringstream oss;
+        oss << "FAIL: " << why << " | after " << op << " | step=" << step << " | size=" << tree.size()
+            << " | n=" << n << " | seed=" << seed << " | ranked=" << Ranked;
+        return oss.str();
+    };
+
+    std::string r = check_validate_sees_ancestors<Ranked>();
+    if (!r.empty())
+        return fail(0, "VALIDATE", r);
+
+    for (int step = 0; step < n; step++) {
+        // phases of n/8 steps: mostly inserts, then mostly erases, so the
+        // tree fills and drains a few times and the free list gets long
+        bool draining = step / std::max(1, n / 8) % 2 == 1;
+        bool erase = !live.empty() && rng() % 4 < (draining ? 3u : 1u);
+        const char* op;
+
+        if (erase) {
+            op = "ERASE";
+            size_t i = rng() % live.size();
+            int id = live[i];
+            live[i] = live.back();
+            live.pop_back();
+            tree.erase(handle[id]);
+            reference.erase(value_of[id]);
+            handle[id] = Tree::NIL;
+        } else {
+            op = "INSERT";
+            int id = (int)handle.size();
+            Value v(rng() % (n / 4 + 1), id);  // small key range: plenty of equal keys
+            size_t pool_before = tree.pool_size();
+            bool has_free = pool_before > tree.size();
+            uint32_t h = tree.insert(v);
+            if (has_free && tree.pool_size() != pool_before)
+                return fail(step, op, "a free slot was there but the pool grew");
+            reused += has_free;
+            handle.push_back(h);
+            value_of.push_back(v);
+            live.push_back(id);
+            reference.insert(v);
+        }
+
+        r = check(tree, reference, handle, value_of);
+        if (!r.empty())
+            return fail(step, op, r);
+
+        if (step % 97 == 96) {
+            op = "COMPACT";
+            std::vector<uint32_t> renamed(handle.size(), Tree::NIL);
+            tree.compact([&](const Value& v, uint32_t index) { renamed[v.second] = index; });
+            for (int id : live)
+                if (renamed[id] == Tree::NIL)
+                    return fail(step, op, "moved() skipped a live node");
+            handle.swap(renamed);
+            if (tree.pool_size() != tree.size())
+                return fail(step, op, "free slots left after compact");
+            r = check(tree, reference, handle, value_of);
+            if (!r.empty())
+                return fail(step, op, r);
+            compacts++;
+        }
+    }
+
+    std::ostringstream oss;
+    oss << "PASS: " << n << " operations, " << compacts << " compacts, " << reused
+        << " inserts into a freed slot | seed=" << seed << " | ranked=" << Ranked;
+    return oss.str();
+}
+
+std::string run_rbtree_pool_generated_test(int n, unsigned seed, bool ranked) {
+    return ranked ? run_test<true>(n, seed) : run_test<false>(n, seed);
+}
@@ -0,0 +1,11 @@
+#ifndef C_IMPLEMENTATION_RBTREE_POOL_TEST_H
+#define C_IMPLEMENTATION_RBTREE_POOL_TEST_H
+
+#include <string>
+
+// Random inserts and erases on a dsa::PooledRBTree (ranked = with subtree
+// sizes), checked against a std::set after every operation.
+// "PASS ..." or "FAIL: ..." with the step
+std::string run_rbtree_pool_generated_test(int n, unsigned seed = 123456789u, bool ranked = false);
+
+#endif
@@ -0,0 +1,485 @@
+#ifndef C_IMPLEMENTATION_RBTREE_TEMPLATE_H
+#define C_IMPLEMENTATION_RBTREE_TEMPLATE_H
+
+/* =====================================================================
+ * RED-BLACK TREE - C++ TEMPLATE VERSION
+ * =====================================================================
+ * The five red-black properties are listed in rbtree.cpp - the C API
+ * there is now a thin wrapper around this template. Two things changed
+ * for speed:
+ *
+ * 1. COMPARE IS A TEMPLATE PARAMETER
+ *    The C tree called tree->compare through a function pointer on every
+ *    level. Here Compare is a type, so the compiler sees its body and
+ *    inlines it - comparing two integers becomes one instruction.
+ *    Compare works like std::less: comp(a, b) == true  <=>  a goes first.
+ *
+ * 2. SMALLER NODES
+ *    The payload is stored by value inside the node, and the color is
+ *    packed into the lowest bit of the parent pointer (nodes are at least
+ *    8 byte aligned, so that bit is always 0 in a real address):
+ *
+ *        C node:    data* | parent | left | right | int color  = 40 bytes
+ *        this node: parent+color | left | right | T value      = 24 + sizeof(T)
+ *
+ *    Fewer bytes per node = more of the tree stays in cache.
+ *
+ * Also keeps a pointer to the leftmost node, so min() is O(1).
+ *
+ * RANKED TREES (Ranked = true):
+ * Every node also stores the size of its subtree. Then "how many values
+ * come before this one" is one walk from the root (or up from the node),
+ * adding up the sizes of the left subtrees we pass:
+ *
+ *              D(5)
+ *             /    \
+ *          B(3)    E(1)       rank(C) = size(B.left) + 1   (A and B)
+ *         /    \
+ *      A(1)    C(1)
+ *
+ * The sizes only change on the insert / erase path (+1 / -1 per level)
+ * and in rotations (two nodes swap places, see rotate_left). It costs a
+ * 4 byte field per node, so it is off by default.
+ * ===================================================================== */
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+namespace dsa {
+
+struct NoSubtreeSize {};
+
+template <class T, class Compare = std::less<T>, bool Ranked = false>
+class RBTree {
+public:
+    typedef std::conditional_t<Ranked, uint32_t, NoSubtreeSize> SubtreeSize;
+
+    struct Node {
+        uintptr_t parent_color; // parent pointer | color (bit 0: 1 = red, 0 = black)
+        Node* left;
+        Node* right;
+        [[no_unique_address]] SubtreeSize count; // nodes in this subtree (Ranked only)
+        T value;
+
+        Node* parent() const { return (Node*)(parent_color & ~(uintptr_t)1); }
+        bool red() const { return parent_color & 1; }
+    };
+
+    explicit RBTree(Compare comp = Compare()) : comp_(comp) {}
+    ~RBTree() { clear(); }
+
+    RBTree(const RBTree&) = delete;
+    RBTree& operator=(const RBTree&) = delete;
+
+    Node* insert(T value);          // returns the node as a handle for erase()
+    void erase(Node* z);            // O(log n), no search needed
+    bool erase(const T& value);     // finds an equivalent value first
+    Node* find(const T& value) const;
+
+    Node* first() const { return leftmost_; }
+    const T* min() const { return leftmost_ ? &leftmost_->value : nullptr; }
+    static Node* next(Node* n);     // in-order successor, nullptr after the last
+
+    // Ranked only, O(log n): values before n / values that compare less than value
+    static size_t rank(const Node* n);
+    size_t count_less(const T& value) const;
+
+    bool empty() const { return root_ == nullptr; }
+    size_t size() const { return size_; }
+    void clear();
+
+private:
+    Node* root_ = nullptr;
+    Node* leftmost_ = nullptr;
+    size_t size_ = 0;
+    [[no_unique_address]] Compare comp_;
+
+    static bool is_red(const Node* n) { return n && n->red(); }  // NULL leaves are black
+    static void set_red(Node* n) { n->parent_color |= 1; }
+    static void set_black(Node* n) { if (n) n->parent_color &= ~(uintptr_t)1; }
+    static void set_color(Node* n, bool red) { n->parent_color = (uintptr_t)n->parent() | red; }
+    static void set_parent(Node* n, Node* p) { n->parent_color = (uintptr_t)p | (n->parent_color & 1); }
+
+    static size_t count(const Node* n) {
+        if constexpr (Ranked)
+            return n ? n->count : 0;
+        else
+            return 0;
+    }
+    static void recount(Node* n) {
+        if constexpr (Ranked)
+            n->count = (uint32_t)(1 + count(n->left) + count(n->right));
+    }
+
+    static Node* min_node(Node* n) {
+        while (n->left)
+            n = n->left;
+        return n;
+    }
+
+    // Hooks new_child into the place old_child had under parent (or the root)
+    void replace_child(Node* parent, Node* old_child, Node* new_child) {
+        if (!parent)
+            root_ = new_child;
+        else if (parent->left == old_child)
+            parent->left = new_child;
+        else
+            parent->right = new_child;
+    }
+
+    void transplant(Node* u, Node* v) {
+        replace_child(u->parent(), u, v);
+        if (v)
+            set_parent(v, u->parent());
+    }
+
+    void rotate_left(Node* x);
+    void rotate_right(Node* x);
+    void fix_insert(Node* z);
+    void fix_delete(Node* x, Node* p);
+    static void free_nodes(Node* n);
+};
+
+/* =====================================================================
+ * Rotations: local restructuring that keeps the BST order
+ * =====================================================================
+ *        x                   y
+ *       / \                 / \
+ *      A   y      =>       x   C          rotate_left(x)
+ *         / \             / \
+ *        B   C           A   B            rotate_right(y) goes back
+ *
+ * y moves up into x's place, x becomes y's child and the middle subtree
+ * B changes sides. Only parent pointers of x, y and B change (and the
+ * color bit travels with them untouched).
+ *
+ * Subtree sizes: y now holds everything x held, and x lost y's side, so
+ * y.count = old x.count and x is counted again from its new children.
+ * ===================================================================== */
+template <class T, class Compare, bool Ranked>
+void RBTree<T, Compare, Ranked>::rotate_left(Node* x) {
+    Node* y = x->right;
+    x->right = y->left;
+    if (y->left)
+        set_parent(y->left, x);
+    set_parent(y, x->parent());
+    replace_child(x->parent(), x, y);
+    y->left = x;
+    set_parent(x, y);
+    if constexpr (Ranked) {
+        y->count = x->count;
+        recount(x);
+    }
+}
+
+template <class T, class Compare, bool Ranked>
+void RBTree<T, Compare, Ranked>::rotate_right(Node* x) {
+    Node* y = x->left;
+    x->left = y->right;
+    if (y->right)
+        set_parent(y->right, x);
+    set_parent(y, x->parent());
+    replace_child(x->parent(), x, y);
+    y->right = x;
+    set_parent(x, y);
+    if constexpr (Ranked) {
+        y->count = x->count;
+        recount(x);
+    }
+}
+
+/* =====================================================================
+ * insert: walk down once (ONE compare per level - the C version compared
+ * the parent a second time), hang a RED node there, then fix_insert.
+ * ===================================================================== */
+template <class T, class Compare, bool Ranked>
+typename RBTree<T, Compare, Ranked>::Node* RBTree<T, Compare, Ranked>::insert(T value) {
+    Node* parent = nullptr;
+    Node** link = &root_;
+    bool is_leftmost = true;
+
+    while (*link) {
+        parent = *link;
+        if constexpr (Ranked)
+            parent->count++;  // the new node ends up below every node on the way
+        if (comp_(value, parent->value)) {
+            link = &parent->left;
+        } else {
+            link = &parent->right;  // equal values go right, after the old ones
+            is_leftmost = false;
+        }
+    }
+
+    Node* z = new Node{(uintptr_t)parent | 1, nullptr, nullptr, SubtreeSize(), std::move(value)};
+    if constexpr (Ranked)
+        z->count = 1;
+    *link = z;
+    if (is_leftmost)
+        leftmost_ = z;
+    size_++;
+
+    fix_insert(z);
+    return z;
+}
+
+/* =====================================================================
+ * fix_insert: the new RED node z may sit under a RED parent
+ * =====================================================================
+ * CASE 1: uncle RED   - recolor parent + uncle black, grandparent red,
+ *                       continue from the grandparent
+ * CASE 2: uncle BLACK - at most two rotations and we are done
+ * ===================================================================== */
+template <class T, class Compare, bool Ranked>
+void RBTree<T, Compare, Ranked>::fix_insert(Node* z) {
+    Node* p;
+    while ((p = z->parent()) && p->red()) {
+        Node* g = p->parent();  // p is red so it is not the root, g exists
+
+        if (p == g->left) {
+            Node* y = g->right;
+            if (is_red(y)) {
+                set_black(p);
+                set_black(y);
+                set_red(g);
+                z = g;
+            } else {
+                if (z == p->right) {
+                    rotate_left(p);
+                    z = p;
+                    p = z->parent();
+                }
+                set_black(p);
+                set_red(g);
+                rotate_right(g);
+            }
+        } else {
+            Node* y = g->left;
+            if (is_red(y)) {
+                set_black(p);
+                set_black(y);
+                set_red(g);
+                z = g;
+            } else {
+                if (z == p->left) {
+                    rotate_right(p);
+                    z = p;
+                    p = z->parent();
+                }
+                set_black(p);
+                set_red(g);
+                rotate_left(g);
+            }
+        }
+    }
+    set_black(root_);  // ROOT IS ALWAYS BLACK
+}
+
+/* =====================================================================
+ * erase: standard BST removal, then fix_delete if a BLACK node went away
+ * =====================================================================
+ * x is the node that took the removed one's place and may be NULL, so we
+ * track its parent (xp) separately - x->parent doesn't exist for NULL.
+ * ===================================================================== */
+template <class T, class Compare, bool Ranked>
+void RBTree<T, Compare, Ranked>::erase(Node* z) {
+    if (z == leftmost_)  // the leftmost has no left child
+        leftmost_ = z->right ? min_node(z->right) : z->parent();
+
+    if constexpr (Ranked) {
+        // one node leaves from z's place, or from the successor's place when
+        // z has two children - every node above that place loses one
+        Node* from = z->left && z->right ? min_node(z->right)->parent() : z->parent();
+        for (; from; from = from->parent())
+            from->count--;
+    }
+
+    Node* x;
+    Node* xp;
+    bool removed_black;
+
+    if (!z->left) {
+        x = z->right;
+        xp = z->parent();
+        removed_black = !z->red();
+        transplant(z, x);
+    } else if (!z->right) {
+        x = z->left;
+        xp = z->parent();
+        removed_black = !z->red();
+        transplant(z, x);
+    } else {
+        Node* y = min_node(z->right);  // in-order successor takes z's place
+        removed_black = !y->red();
+        x = y->right;
+
+        if (y->parent() == z) {
+            xp = y;
+        } else {
+            xp = y->parent();
+            transplant(y, x);
+            y->right = z->right;
+            set_parent(y->right, y);
+        }
+
+        transplant(z, y);
+        y->left = z->left;
+        set_parent(y->left, y);
+        set_color(y, z->red());
+        if constexpr (Ranked)
+            y->count = z->count;  // already one less, z was on the path above
+    }
+
+    size_--;
+    if (removed_black)
+        fix_delete(x, xp);
+    delete z;
+}
+
+/* =====================================================================
+ * fix_delete: x carries an extra BLACK ("double black"), p is its parent
+ * =====================================================================
+ * CASE 1: sibling w RED                 - rotate so w becomes black
+ * CASE 2: w BLACK, both children BLACK  - w red, move the problem up
+ * CASE 3: w BLACK, a RED child          - rotate + recolor, done
+ * ===================================================================== */
+template <class T, class Compare, bool Ranked>
+void RBTree<T, Compare, Ranked>::fix_delete(Node* x, Node* p) {
+    while (x != root_ && !is_red(x)) {
+        if (x == p->left) {
+            Node* w = p->right;  // can't be NULL: that side has black height >= 1
+
+            if (w->red()) {
+                set_black(w);
+                set_red(p);
+                rotate_left(p);
+                w = p->right;
+            }
+            if (!is_red(w->left) && !is_red(w->right)) {
+                set_red(w);
+                x = p;
+                p = x->parent();
+            } else {
+                if (!is_red(w->right)) {
+                    set_black(w->left);
+                    set_red(w);
+                    rotate_right(w);
+                    w = p->right;
+                }
+                set_color(w, p->red());
+                set_black(p);
+                set_black(w->right);
+                rotate_left(p);
+                x = root_;
+            }
+        } else {
+            Node* w = p->left;
+
+            if (w->red()) {
+                set_black(w);
+                set_red(p);
+                rotate_right(p);
+                w = p->left;
+            }
+            if (!is_red(w->right) && !is_red(w->left)) {
+                set_red(w);
+                x = p;
+                p = x->parent();
+            } else {
+                if (!is_red(w->left)) {
+                    set_black(w->right);
+                    set_red(w);
+                    rotate_left(w);
+                    w = p->left;
+                }
+                set_color(w, p->red());
+                set_black(p);
+                set_black(w->left);
+                rotate_right(p);
+                x = root_;
+            }
+        }
+    }
+    set_black(x);
+}
+
+template <class T, class Compare, bool Ranked>
+bool RBTree<T, Compare, Ranked>::erase(const T& value) {
+    Node* z = find(value);
+    if (!z)
+        return false;
+    erase(z);
+    return true;
+}
+
+template <class T, class Compare, bool Ranked>
+typename RBTree<T, Compare, Ranked>::Node* RBTree<T, Compare, Ranked>::find(const T& value) const {
+    Node* x = root_;
+    while (x) {
+        if (comp_(value, x->value))
+            x = x->left;
+        else if (comp_(x->value, value))
+            x = x->right;
+        else
+            return x;
+    }
+    return nullptr;
+}
+
+template <class T, class Compare, bool Ranked>
+typename RBTree<T, Compare, Ranked>::Node* RBTree<T, Compare, Ranked>::next(Node* n) {
+    if (n->right)
+        return min_node(n->right);
+    Node* p = n->parent();
+    while (p && n == p->right) {
+        n = p;
+        p = p->parent();
+    }
+    return p;
+}
+
+template <class T, class Compare, bool Ranked>
+size_t RBTree<T, Compare, Ranked>::rank(const Node* n) {
+    static_assert(Ranked, "rank() needs RBTree<T, Compare, true>");
+    size_t r = count(n->left);
+    for (const Node* p = n->parent(); p; n = p, p = p->parent())
+        if (n == p->right)
+            r += count(p->left) + 1;  // p and its left side come before us
+    return r;
+}
+
+template <class T, class Compare, bool Ranked>
+size_t RBTree<T, Compare, Ranked>::count_less(const T& value) const {
+    static_assert(Ranked, "count_less() needs RBTree<T, Compare, true>");
+    size_t r = 0;
+    for (const Node* x = root_; x; ) {
+        if (comp_(x->value, value)) {
+            r += count(x->left) + 1;
+            x = x->right;
+        } else {
+            x = x->left;
+        }
+    }
+    return r;
+}
+
+template <class T, class Compare, bool Ranked>
+void RBTree<T, Compare, Ranked>::free_nodes(Node* n) {
+    if (!n) return;
+    free_nodes(n->left);
+    free_nodes(n->right);
+    delete n;
+}
+
+template <class T, class Compare, bool Ranked>
+void RBTree<T, Compare, Ranked>::clear() {
+    free_nodes(root_);
+    root_ = leftmost_ = nullptr;
+    size_ = 0;
+}
+
+} // namespace dsa
+
+#endif
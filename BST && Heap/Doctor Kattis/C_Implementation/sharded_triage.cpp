@@ -0,0 +1,215 @@
+/* =====================================================================
+ * SHARDED TRIAGE - the clinic on several threads
+ * =====================================================================
+ *
+ *                        +--> [SPSC queue] --> worker 0: triage_t (its patients)
+ *   router (caller)  ----+--> [SPSC queue] --> worker 1: triage_t
+ *   reads commands       +--> [SPSC queue] --> worker 2: triage_t
+ *
+ * PARTITIONING:
+ * A patient lives in exactly one shard, picked by the hash of the name.
+ * Admit / bump / discharge only ever touch that one shard, so shards
+ * never share data and need no locks. Each worker runs a normal,
+ * single-threaded triage_t (any backend).
+ *
+ * ARRIVAL ORDER:
+ * Ties are broken by arrival, and that has to be the GLOBAL arrival -
+ * a shard's own counter would mean nothing next to another shard's.
+ * So the router numbers every admit and the worker uses that number
+ * (triage_admit_at).
+ *
+ * "NEXT PATIENT":
+ * The answer is the best of the shard minimums. The router waits until
+ * each queue is drained (the worker has finished every command sent
+ * before this query), then reads each shard's top patient and compares
+ * the packed (severity, arrival) keys. The read is safe without a lock:
+ * the worker only moves again when the router sends it more work, and
+ * the router is the one reading.
+ *
+ * Top k and positions work the same way: wait for every shard, then
+ * merge the shards' own top k lists / add up how many patients each
+ * shard has ahead of X.
+ *
+ * So the output is exactly the single-threaded output. The price is
+ * that a query waits for all shards; the speedup comes from the
+ * commands BETWEEN queries, which run on all workers at once.
+ * ===================================================================== */
+
+#include "sharded_triage.h"
+#include "spsc_queue.h"
+#include <cstdlib>
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#define SHARD_QUEUE_SIZE 4096
+#define COMMAND_INLINE_NAME 40
+
+enum { CMD_ADMIT, CMD_BUMP, CMD_DISCHARGE, CMD_STOP };
+
+// One command = one cache line. Longer names go to the heap (worker frees them)
+typedef struct {
+    int op;
+    int value;     // severity or increase
+    int arrival;   // admit only
+    char* long_name;
+    char name[COMMAND_INLINE_NAME];
+} triage_command_t;
+
+typedef struct {
+    SpscQueue<triage_command_t>* queue;
+    triage_t* clinic;
+    std::thread thread;
+} triage_shard_t;
+
+struct sharded_triage {
+    unsigned shard_count;
+    triage_shard_t* shards;
+    int arrival;
+};
+
+// An idle worker parks in wait_front() until the router pushes (spsc_queue.h)
+static void worker_loop(triage_shard_t* shard) {
+    while (true) {
+        triage_command_t* c = shard->queue->wait_front();
+        if (c->op == CMD_STOP) {
+            shard->queue->pop();
+            return;
+        }
+
+        const char* name = c->long_name ? c->long_name : c->name;
+        if (c->op == CMD_ADMIT)
+            triage_admit_at(shard->clinic, name, c->value, c->arrival);
+        else if (c->op == CMD_BUMP)
+            triage_bump(shard->clinic, name, c->value);
+        else
+            triage_discharge(shard->clinic, name);
+
+        free(c->long_name);
+        shard->queue->pop();  // only now: drained() means "done", not "taken"
+    }
+}
+
+sharded_triage_t* sharded_triage_create(unsigned shards, triage_mode_t mode) {
+    sharded_triage_t* st = new sharded_triage_t;
+    st->shard_count = shards ? shards : 1;
+    st->shards = new triage_shard_t[st->shard_count];
+    st->arrival = 0;
+    for (unsigned i = 0; i < st->shard_count; i++) {
+        triage_shard_t* s = &st->shards[i];
+        s->queue = new SpscQueue<triage_command_t>(SHARD_QUEUE_SIZE);
+        s->clinic = triage_create(mode);
+        s->thread = std::thread(worker_loop, s);
+    }
+    return st;
+}
+
+// Bits 32+ of the name hash, like concurrent_hash_map, so the shard's own
+// hash map (low bits) still sees well spread keys
+static triage_shard_t* shard_for(sharded_triage_t* st, const char* name) {
+    unsigned long long h = hash_str(name);
+    return &st->shards[(h >> 32) % st->shard_count];
+}
+
+static void send(sharded_triage_t* st, int op, const char* name, int value, int arrival) {
+    size_t len = strlen(name);
+    triage_command_t c;
+    c.op = op;
+    c.value = value;
+    c.arrival = arrival;
+    if (len < COMMAND_INLINE_NAME) {
+        memcpy(c.name, name, len + 1);
+        c.long_name = NULL;
+    } else {
+        c.long_name = (char*)malloc(len + 1);
+        memcpy(c.long_name, name, len + 1);
+    }
+    shard_for(st, name)->queue->push(c);
+}
+
+void sharded_triage_admit(sharded_triage_t* st, const char* name, int severity) {
+    send(st, CMD_ADMIT, name, severity, st->arrival++);
+}
+
+void sharded_triage_bump(sharded_triage_t* st, const char* name, int increase) {
+    send(st, CMD_BUMP, name, increase, 0);
+}
+
+void sharded_triage_discharge(sharded_triage_t* st, const char* name) {
+    send(st, CMD_DISCHARGE, name, 0, 0);
+}
+
+// Waits until every worker has finished what it was sent; after that the
+// router may read the shards' triage_t's until it sends something new
+static void wait_for_all(sharded_triage_t* st) {
+    for (unsigned i = 0; i < st->shard_count; i++) {
+        unsigned spins = 0;
+        while (!st->shards[i].queue->drained())
+            spsc_backoff(spins);
+    }
+}
+
+const char* sharded_triage_next(sharded_triage_t* st) {
+    Patient* best = NULL;
+    uint64_t best_key = 0;
+
+    wait_for_all(st);
+    for (unsigned i = 0; i < st->shard_count; i++) {
+        triage_shard_t* s = &st->shards[i];
+        Patient* p = triage_top(s->clinic);
+        if (!p)
+            continue;
+        uint64_t key = priority_key(p->severity, p->arrival);
+        if (!best || key < best_key) {
+            best = p;
+            best_key = key;
+        }
+    }
+    return best ? best->name.c_str() : NULL;
+}
+
+typedef std::vector<std::pair<uint64_t, Patient*>> ranked_patients_t;
+
+static void collect_patient(Patient* p, void* ctx) {
+    ((ranked_patients_t*)ctx)->push_back({priority_key(p->severity, p->arrival), p});
+}
+
+void sharded_triage_top_k(sharded_triage_t* st, int k, void (*fn)(Patient* p, void* ctx), void* ctx) {
+    wait_for_all(st);
+    ranked_patients_t all;  // the global top k is among the shards' top k's
+    for (unsigned i = 0; i < st->shard_count; i++)
+        triage_top_k(st->shards[i].clinic, k, collect_patient, &all);
+
+    size_t n = std::min(all.size(), (size_t)std::max(k, 0));
+    std::partial_sort(all.begin(), all.begin() + n, all.end());
+    for (size_t i = 0; i < n; i++)
+        fn(all[i].second, ctx);
+}
+
+int sharded_triage_position(sharded_triage_t* st, const char* name) {
+    wait_for_all(st);
+    Patient* p = triage_find(shard_for(st, name)->clinic, name);
+    if (!p)
+        return 0;
+    int ahead = 0;
+    for (unsigned i = 0; i < st->shard_count; i++)
+        ahead += triage_count_before(st->shards[i].clinic, p);
+    return ahead + 1;
+}
+
+void sharded_triage_free(sharded_triage_t* st) {
+    triage_command_t stop = {};
+    stop.op = CMD_STOP;
+    for (unsigned i = 0; i < st->shard_count; i++)
+        st->shards[i].queue->push(stop);
+    for (unsigned i = 0; i < st->shard_count; i++) {
+        triage_shard_t* s = &st->shards[i];
+        s->thread.join();
+        triage_free(s->clinic);
+        delete s->queue;
+    }
+    delete[] st->shards;
+    delete st;
+}
@@ -0,0 +1,28 @@
+#ifndef C_IMPLEMENTATION_SHARDED_TRIAGE_H
+#define C_IMPLEMENTATION_SHARDED_TRIAGE_H
+
+#include "triage.h"
+
+// Same four commands as triage.h, spread over worker threads (see sharded_triage.cpp).
+// Only ONE thread may call these functions - it is the producer of every shard queue.
+typedef struct sharded_triage sharded_triage_t;
+
+sharded_triage_t* sharded_triage_create(unsigned shards, triage_mode_t mode);
+
+void sharded_triage_admit(sharded_triage_t* st, const char* name, int severity);
+
+void sharded_triage_bump(sharded_triage_t* st, const char* name, int increase);
+
+void sharded_triage_discharge(sharded_triage_t* st, const char* name);
+
+// Waits for every shard to catch up. The name stays valid until the next call.
+const char* sharded_triage_next(sharded_triage_t* st);
+
+// Same as triage_top_k / triage_position, over all shards
+void sharded_triage_top_k(sharded_triage_t* st, int k, void (*fn)(Patient* p, void* ctx), void* ctx);
+
+int sharded_triage_position(sharded_triage_t* st, const char* name);
+
+void sharded_triage_free(sharded_triage_t* st);
+
+#endif
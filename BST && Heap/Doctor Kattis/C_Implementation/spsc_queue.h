@@ -0,0 +1,157 @@
+#ifndef C_IMPLEMENTATION_SPSC_QUEUE_H
+#define C_IMPLEMENTATION_SPSC_QUEUE_H
+
+/* =====================================================================
+ * SPSC QUEUE - one producer thread, one consumer thread, no locks
+ * =====================================================================
+ * A ring buffer of power-of-2 size with two counters that only grow:
+ *
+ *   tail - written ONLY by the producer (next slot to fill)
+ *   head - written ONLY by the consumer (next slot to read)
+ *
+ *   empty: head == tail       full: tail - head == capacity
+ *
+ * Since each counter has a single writer there is nothing to fight
+ * over - no compare-and-swap, just a store with release order after
+ * the slot is written / read, and a load with acquire order on the
+ * other side, so the slot contents travel with the counter.
+ *
+ * Each side also keeps a private copy of the OTHER side's counter and
+ * only reloads it when the copy says full / empty, so most operations
+ * never touch the other thread's cache line.
+ *
+ * The consumer reads an element in place with front() and releases the
+ * slot with pop() when it is done with it. So once the producer sees
+ * the queue empty, it knows the consumer has FINISHED everything it
+ * was given, not just taken it out.
+ *
+ * PARKING: a consumer that finds nothing for a while shouldn't burn a
+ * core (or, with more threads than cores, the producer's time slices).
+ * wait_front() spins briefly, then sleeps in std::atomic::wait (a futex
+ * on Linux) until the producer pushes:
+ *
+ *   consumer: sleeping_ = 1; fence; queue still empty? -> wait(sleeping_ == 1)
+ *   producer: tail_ += 1;    fence; sleeping_ == 1?    -> sleeping_ = 0, notify
+ *
+ * Both sides write their own word and then read the other's, with a full
+ * fence between: at least one of them sees the other's write, so either
+ * the consumer finds the element or the producer wakes it. The price on
+ * the producer side is that fence and one load of sleeping_ per push; the
+ * system call only happens when the consumer really sleeps.
+ * ===================================================================== */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#define SPSC_CACHE_LINE 64
+#define SPSC_SPINS_BEFORE_PARK 72 // spsc_backoff rounds: 64 pauses, then 8 yields
+
+// Busy waiting that stays polite: spin a little, then give the core away
+static inline void spsc_backoff(unsigned& spins) {
+    if (++spins < 64) {
+#ifdef __SSE2__
+        _mm_pause();
+#endif
+    } else {
+        std::this_thread::yield();
+    }
+}
+
+template <class T>
+class SpscQueue {
+public:
+    explicit SpscQueue(size_t capacity) {
+        size_t cap = 1;
+        while (cap < capacity)
+            cap <<= 1;
+        slots_ = new T[cap];
+        mask_ = cap - 1;
+    }
+    ~SpscQueue() { delete[] slots_; }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // producer side
+    bool try_push(const T& value) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_cache_ > mask_) {
+            head_cache_ = head_.load(std::memory_order_acquire);
+            if (tail - head_cache_ > mask_)
+                return false;  // full
+        }
+        slots_[tail & mask_] = value;
+        tail_.store(tail + 1, std::memory_order_release);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleeping_.load(std::memory_order_relaxed)) {
+            sleeping_.store(0, std::memory_order_relaxed);
+            sleeping_.notify_one();
+        }
+        return true;
+    }
+
+    void push(const T& value) {
+        unsigned spins = 0;
+        while (!try_push(value))
+            spsc_backoff(spins);
+    }
+
+    // producer side: true once the consumer has popped everything
+    bool drained() const {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_relaxed);
+    }
+
+    // consumer side: the oldest element, NULL if there is none
+    T* front() {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_cache_) {
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+            if (head == tail_cache_)
+                return nullptr;
+        }
+        return &slots_[head & mask_];
+    }
+
+    // consumer side: front(), but waits for an element - spins, then parks
+    T* wait_front() {
+        for (unsigned spins = 0; ; ) {
+            if (T* value = front())
+                return value;
+            if (spins < SPSC_SPINS_BEFORE_PARK) {
+                spsc_backoff(spins);
+                continue;
+            }
+            sleeping_.store(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (T* value = front()) {  // pushed before the producer could see sleeping_
+                sleeping_.store(0, std::memory_order_relaxed);
+                return value;
+            }
+            sleeping_.wait(1, std::memory_order_relaxed);  // returns at once if already woken
+        }
+    }
+
+    void pop() {
+        head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+private:
+    // consumer's line
+    alignas(SPSC_CACHE_LINE) std::atomic<size_t> head_{0};
+    size_t tail_cache_ = 0;
+    // producer's line
+    alignas(SPSC_CACHE_LINE) std::atomic<size_t> tail_{0};
+    size_t head_cache_ = 0;
+    // 1 while the consumer is parked in wait_front(), on its own line: the producer reads it every push
+    alignas(SPSC_CACHE_LINE) std::atomic<uint32_t> sleeping_{0};
+    // read only after construction
+    alignas(SPSC_CACHE_LINE) T* slots_;
+    size_t mask_;
+};
+
+#endif
@@ -0,0 +1,287 @@
+#include "store_test.h"
+#include "triage_store.h"
+
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <random>
+#include <sstream>
+#include <utility>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+/* =====================================================================
+ * Recovery test for triage_store
+ * =====================================================================
+ * Every case writes a clinic through the store, breaks the files the way
+ * a crash (or a disk) would, opens the directory again into an empty
+ * clinic and compares it with what it has to be:
+ *
+ *   torn tail        the last record cut short    -> everything before it
+ *   garbage tail     the last record's bytes bad  -> everything before it
+ *   old journal      crash after the snapshot rename, before the journal
+ *                    reset: the journal is all in the snapshot -> the
+ *                    snapshot, nothing replayed twice
+ *   newer journal    the snapshot is older than the journal -> refused
+ *   damaged header   journal magic / version / garbage -> refused, the
+ *                    file untouched
+ *   torn header      a reset cut short -> the snapshot
+ *   damaged snapshot -> refused
+ *   failed flush     a write stops halfway (RLIMIT_FSIZE), the retry
+ *                    must not append the first part again
+ *   failed reset     the snapshot is in, the journal reset after it
+ *                    fails (old journal, or an empty one): the next
+ *                    flushes must reset it before appending
+ *
+ * "Compare" = every waiting patient's severity and arrival, plus the next
+ * arrival number: a command replayed twice or lost changes one of them.
+ * After the repairs the store is used again and reopened once more.
+ * ===================================================================== */
+
+struct State {
+    std::map<std::string, std::pair<int, int>> patients; // name -> severity, arrival
+    int next_arrival = 0;
+    bool operator==(const State& o) const { return patients == o.patients && next_arrival == o.next_arrival; }
+};
+
+static void add_patient(const char* name, void* value, void* ctx) {
+    Patient* p = (Patient*)value;
+    ((State*)ctx)->patients[name] = {p->severity, p->arrival};
+}
+
+static State state_of(triage_t* t) {
+    State s;
+    hash_map_foreach(t->dict, add_patient, &s);
+    s.next_arrival = t->arrival;
+    return s;
+}
+
+static std::string read_file(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+static void write_file(const std::string& path, const std::string& bytes) {
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << bytes;
+}
+
+// The descriptor this process has open on path, -1 if none
+static int open_fd_of(const std::string& path) {
+    int found = -1;
+    DIR* fds = opendir("/proc/self/fd");
+    while (dirent* e = fds ? readdir(fds) : NULL) {
+        char target[4096];
+        std::string link = std::string("/proc/self/fd/") + e->d_name;
+        ssize_t n = readlink(link.c_str(), target, sizeof(target) - 1);
+        if (n > 0 && std::string(target, n) == path)
+            found = atoi(e->d_name);
+    }
+    if (fds)
+        closedir(fds);
+    return found;
+}
+
+// A clinic with its store, commands go to both like in triage_server
+struct Session {
+    triage_t* clinic;
+    triage_store_t* store;
+
+    explicit Session(const std::string& dir) : clinic(triage_create(TRIAGE_BUCKETS)) {
+        store = triage_store_open(dir.c_str(), clinic, 0);
+    }
+    ~Session() {
+        triage_store_close(store);
+        triage_free(clinic);
+    }
+
+    void run(std::mt19937& rng, int commands) {
+        for (int i = 0; i < commands; i++) {
+            std::string name = "p" + std::to_string(rng() % 40);
+            int value = (int)(rng() % 100);
+            switch (rng() % 4) {
+                case 0:
+                case 1:
+                    triage_store_log_admit(store, name.c_str(), value);
+                    triage_admit(clinic, name.c_str(), value);
+                    break;
+                case 2:
+                    triage_store_log_bump(store, name.c_str(), value - 30);
+                    triage_bump(clinic, name.c_str(), value - 30);
+                    break;
+                default:
+                    triage_store_log_discharge(store, name.c_str());
+                    triage_discharge(clinic, name.c_str());
+            }
+        }
+    }
+};
+
+// Opens dir again: true + its state, or false if the store refused
+static bool reopen(const std::string& dir, State* state) {
+    Session s(dir);
+    if (s.store)
+        *state = state_of(s.clinic);
+    return s.store != NULL;
+}
+
+std::string run_store_recovery_test(unsigned seed) {
+    std::cout << "[STORE-TEST] START seed=" << seed << std::endl;
+    char dir_template[] = "/tmp/triage_store_test.XXXXXX";
+    if (!mkdtemp(dir_template))
+        return "FAIL: mkdtemp";
+    const std::string dir = dir_template, snapshot = dir + "/snapshot.bin", journal = dir + "/journal.bin";
+    std::mt19937 rng(seed);
+    std::string failure;
+    auto expect = [&](bool ok, const std::string& what) {
+        if (!ok && failure.empty())
+            failure = what;
+    };
+    State want, got;
+
+    {   // a snapshot, then a journal on top of it: 99 commands, remember, then 1 more
+        Session s(dir);
+        expect(s.store != NULL, "open of an empty directory");
+        s.run(rng, 200);
+        expect(triage_store_snapshot(s.store, s.clinic) == 0, "snapshot");
+        s.run(rng, 99);
+        triage_store_flush(s.store);
+        want = state_of(s.clinic);
+        s.run(rng, 1);
+        triage_store_flush(s.store);
+    }
+    const std::string written = read_file(journal);
+    const size_t before_last = written.size() - 3; // well inside the last record
+
+    // torn tail: cut into the last record
+    write_file(journal, written.substr(0, before_last));
+    expect(reopen(dir, &got) && got == want, "torn tail: not the state before the last command");
+    expect(read_file(journal).size() < before_last, "torn tail: not cut off");
+
+    // garbage tail: the last record whole, one byte of its name changed
+    std::string garbage = written;
+    garbage[garbage.size() - 2] ^= 0x55;
+    write_file(journal, garbage);
+    expect(reopen(dir, &got) && got == want, "garbage tail: not the state before the last command");
+
+    // the repaired journal takes new commands
+    {
+        Session s(dir);
+        s.run(rng, 50);
+        triage_store_flush(s.store);
+        want = state_of(s.clinic);
+    }
+    expect(reopen(dir, &got) && got == want, "appending after a cut tail");
+
+    // crash between the snapshot rename and the journal reset
+    const std::string old_snapshot = read_file(snapshot), old_journal = read_file(journal);
+    {
+        Session s(dir);
+        expect(triage_store_snapshot(s.store, s.clinic) == 0, "second snapshot");
+    }
+    const std::string fresh_journal = read_file(journal);
+    write_file(journal, old_journal);
+    expect(reopen(dir, &got) && got == want, "old journal next to a new snapshot: replayed again");
+    expect(read_file(journal) == fresh_journal, "old journal: not reset to the new generation");
+
+    // a journal newer than its snapshot: the snapshot it belongs to is lost
+    const std::string new_snapshot = read_file(snapshot);
+    write_file(snapshot, old_snapshot);
+    expect(!reopen(dir, &got), "newer journal than snapshot: not refused");
+    write_file(snapshot, new_snapshot);
+
+    // damaged journal headers: refused, and the file is left alone
+    const char* damage[] = {"magic", "version", "garbage"};
+    for (const char* what : damage) {
+        std::string bad = fresh_journal;
+        if (std::string(what) == "magic") bad[0] ^= 1;
+        else if (std::string(what) == "version") bad[8] ^= 1;
+        else bad = "garbage";
+        write_file(journal, bad);
+        expect(!reopen(dir, &got), std::string("journal header ") + what + ": not refused");
+        expect(read_file(journal) == bad, std::string("journal header ") + what + ": the file was changed");
+    }
+
+    // a journal reset cut short: a prefix of the right header is fine
+    write_file(journal, fresh_journal.substr(0, 10));
+    expect(reopen(dir, &got) && got == want, "torn journal header: not the snapshot");
+    expect(read_file(journal) == fresh_journal, "torn journal header: not reset");
+
+    // damaged snapshot
+    std::string bad_snapshot = new_snapshot;
+    bad_snapshot[bad_snapshot.size() - 5] ^= 1;
+    write_file(snapshot, bad_snapshot);
+    expect(!reopen(dir, &got), "damaged snapshot: not refused");
+    write_file(snapshot, new_snapshot);
+
+    // a flush that stops halfway: the file may only grow by 100 bytes
+    {
+        Session s(dir);
+        s.run(rng, 20);
+        expect(triage_store_flush(s.store) == 0, "flush");
+        s.run(rng, 30);
+
+        struct rlimit old_limit, limit;
+        getrlimit(RLIMIT_FSIZE, &old_limit);
+        void (*old_handler)(int) = signal(SIGXFSZ, SIG_IGN);
+        limit = old_limit;
+        limit.rlim_cur = read_file(journal).size() + 100;
+        setrlimit(RLIMIT_FSIZE, &limit);
+        expect(triage_store_flush(s.store) != 0, "flush over RLIMIT_FSIZE: didn't fail");
+        expect(read_file(journal).size() == limit.rlim_cur, "flush over RLIMIT_FSIZE: nothing written");
+        setrlimit(RLIMIT_FSIZE, &old_limit);
+        signal(SIGXFSZ, old_handler);
+
+        expect(triage_store_flush(s.store) == 0, "flush retry");
+        want = state_of(s.clinic);
+    }
+    expect(reopen(dir, &got) && got == want, "flush retry: records lost or written twice");
+
+    // a journal reset that fails after the snapshot rename: the store's
+    // journal descriptor swapped for a read-only one, so ftruncate fails
+    for (bool headerless : {false, true}) {
+        const std::string variant = headerless ? "failed reset, empty journal: " : "failed reset: ";
+        {
+            Session s(dir);
+            s.run(rng, 20);
+            expect(triage_store_flush(s.store) == 0, "flush");
+            int fd = open_fd_of(journal), read_only = open(journal.c_str(), O_RDONLY);
+            if (fd < 0 || read_only < 0) {
+                expect(false, variant + "no journal descriptor");
+                break;
+            }
+            int saved = dup(fd);
+            dup2(read_only, fd);
+            close(read_only);
+            expect(triage_store_snapshot(s.store, s.clinic) != 0, variant + "snapshot didn't fail");
+
+            if (headerless)
+                write_file(journal, "");  // the truncate worked, the header didn't
+            const std::string stale = read_file(journal);
+            s.run(rng, 30);
+            expect(triage_store_flush(s.store) != 0, variant + "flush didn't fail");
+            expect(read_file(journal) == stale, variant + "appended to the stale journal");
+
+            dup2(saved, fd);
+            close(saved);
+            s.run(rng, 10);
+            expect(triage_store_flush(s.store) == 0, variant + "flush after the disk came back");
+            want = state_of(s.clinic);
+        }
+        expect(reopen(dir, &got) && got == want, variant + "commands lost");
+    }
+
+    unlink(snapshot.c_str());
+    unlink(journal.c_str());
+    rmdir(dir.c_str());
+
+    if (!failure.empty())
+        return "FAIL: " + failure + " | seed=" + std::to_string(seed);
+    return "PASS: torn / garbage tail, old and newer journal, damaged headers, failed flush and reset | seed=" +
+           std::to_string(seed);
+}
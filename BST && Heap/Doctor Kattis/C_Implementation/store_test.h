@@ -0,0 +1,11 @@
+#ifndef C_IMPLEMENTATION_STORE_TEST_H
+#define C_IMPLEMENTATION_STORE_TEST_H
+
+#include <string>
+
+// Restarts of a triage_store after the crashes and damage it has to
+// survive (or refuse), the restored clinic compared with the one that
+// wrote it. POSIX only, like triage_store. "PASS ..." or "FAIL: ..."
+std::string run_store_recovery_test(unsigned seed = 123456789u);
+
+#endif
@@ -0,0 +1,236 @@
+/* =====================================================================
+ * SWISS TABLE BACKEND FOR hash_map_t
+ * =====================================================================
+ *
+ * Same open addressing idea as hash_set.cpp, but the table is split in two:
+ *
+ *   ctrl[]  - 1 byte per slot (the "control byte")
+ *   table[] - the hash_entry_t slots themselves (key, value, hash)
+ *
+ * CONTROL BYTE VALUES:
+ *   EMPTY   (0x80 = 1000 0000) - slot was never used
+ *   DELETED (0xFE = 1111 1110) - tombstone, slot was used and then deleted
+ *   0xxxxxxx                   - slot is FULL, low 7 bits = top 7 bits of the hash
+ *
+ * KEY CONCEPT - PROBING A WHOLE GROUP AT ONCE:
+ * Instead of looking at one entry per step, we load 16 control bytes
+ * (one cache line holds 4 groups) and compare all of them against the
+ * 7-bit tag of our key with a single SSE2 instruction:
+ *
+ *   _mm_cmpeq_epi8   -> 0xFF in every byte that matches the tag
+ *   _mm_movemask_epi8 -> squeeze that into a 16-bit mask, 1 bit per slot
+ *
+ * Only the slots whose bit is set are worth opening (1 in 128 chance of a
+ * false positive per slot), so a lookup usually touches one line of ctrl
+ * and one entry. If the group also contains an EMPTY byte the key cannot
+ * be further away, so we stop.
+ *
+ * WRAP AROUND:
+ * ctrl has capacity + 16 bytes; the last 16 are a copy of the first 16,
+ * so a group that starts near the end can be loaded with one unaligned read.
+ *
+ * LOAD FACTOR:
+ * Groups tolerate much fuller tables than single-slot linear probing,
+ * we grow at 7/8 (counting tombstones, they lengthen probes too).
+ *
+ * RESIZING IS STOP-THE-WORLD HERE, on purpose:
+ * hash_set.cpp moves the old table over a few slots per put (INCREMENTAL
+ * RESIZING there). That is NOT done for this backend: a lookup would have
+ * to probe the groups of two tables with two ctrl arrays, which costs the
+ * one-line-of-ctrl lookup this table exists for. rehash() below stays one
+ * pass - use the linear probing backend where the worst put matters.
+ * ===================================================================== */
+
+#include "swiss_table.h"
+#include "hash_entry.h"
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#define CTRL_EMPTY   ((unsigned char)0x80)
+#define CTRL_DELETED ((unsigned char)0xFE)
+
+// H1 picks the starting slot (low bits), H2 is the 7-bit tag (top bits)
+static inline unsigned h1(unsigned long long h, unsigned mask) { return (unsigned)(h & mask); }
+static inline unsigned char h2(unsigned long long h) { return (unsigned char)(h >> 57); }
+
+static inline unsigned max_load(unsigned capacity) { return capacity - capacity / 8; }
+
+/* =====================================================================
+ * group_match / group_match_empty: the 16-wide compares
+ * =====================================================================
+ * Return a bitmask with bit i set when ctrl[i] == tag (or == EMPTY).
+ * Without SSE2 (e.g. ARM) we fall back to a plain loop with the same result.
+ * ===================================================================== */
+static inline unsigned group_match(const unsigned char* ctrl, unsigned char tag) {
+#ifdef __SSE2__
+    __m128i group = _mm_loadu_si128((const __m128i*)ctrl);
+    return (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8((char)tag)));
+#else
+    unsigned mask = 0;
+    for (int i = 0; i < SWISS_GROUP_WIDTH; ++i)
+        mask |= (unsigned)(ctrl[i] == tag) << i;
+    return mask;
+#endif
+}
+
+static inline unsigned group_match_empty(const unsigned char* ctrl) {
+    return group_match(ctrl, CTRL_EMPTY);
+}
+
+// EMPTY and DELETED are the only values with the top bit set
+static inline unsigned group_match_free(const unsigned char* ctrl) {
+#ifdef __SSE2__
+    return (unsigned)_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)ctrl));
+#else
+    unsigned mask = 0;
+    for (int i = 0; i < SWISS_GROUP_WIDTH; ++i)
+        mask |= (unsigned)(ctrl[i] >> 7) << i;
+    return mask;
+#endif
+}
+
+// Writes a control byte and keeps the mirrored tail in sync
+static inline void set_ctrl(hash_map_t* map, unsigned i, unsigned char c) {
+    map->ctrl[i] = c;
+    if (i < SWISS_GROUP_WIDTH)
+        map->ctrl[map->capacity + i] = c;
+}
+
+void swiss_init(hash_map_t* map, unsigned capacity) {
+    if (capacity < SWISS_GROUP_WIDTH)
+        capacity = SWISS_GROUP_WIDTH;
+    map->capacity = capacity;
+    map->length = 0;
+    map->tombstones = 0;
+    map->table = (hash_entry_t*)calloc(capacity, sizeof(hash_entry_t));
+    map->ctrl = (unsigned char*)malloc(capacity + SWISS_GROUP_WIDTH);
+    memset(map->ctrl, CTRL_EMPTY, capacity + SWISS_GROUP_WIDTH);
+}
+
+/* =====================================================================
+ * find_index: Returns the slot holding key, or -1
+ * =====================================================================
+ * Probe sequence: group after group, jumping 16, 32, 48, ... slots
+ * (triangular numbers - visits every group once for power of 2 sizes).
+ * ===================================================================== */
+static long find_index(const hash_map_t* map, const char* key, unsigned long long h) {
+    unsigned mask = map->capacity - 1;
+    unsigned char tag = h2(h);
+    unsigned pos = h1(h, mask);
+
+    for (unsigned step = SWISS_GROUP_WIDTH; ; step += SWISS_GROUP_WIDTH) {
+        const unsigned char* group = map->ctrl + pos;
+        unsigned candidates = group_match(group, tag);
+
+        while (candidates) {
+            unsigned idx = (pos + __builtin_ctz(candidates)) & mask;
+            const hash_entry_t* e = &map->table[idx];
+            if (e->hash == h && strcmp(entry_key(e), key) == 0)
+                return idx;
+            candidates &= candidates - 1;  // clear lowest set bit
+        }
+
+        if (group_match_empty(group))
+            return -1;
+        pos = (pos + step) & mask;
+    }
+}
+
+// First EMPTY or DELETED slot on the probe sequence of h
+static unsigned find_free(const hash_map_t* map, unsigned long long h) {
+    unsigned mask = map->capacity - 1;
+    unsigned pos = h1(h, mask);
+
+    for (unsigned step = SWISS_GROUP_WIDTH; ; step += SWISS_GROUP_WIDTH) {
+        unsigned free_slots = group_match_free(map->ctrl + pos);
+        if (free_slots)
+            return (pos + __builtin_ctz(free_slots)) & mask;
+        pos = (pos + step) & mask;
+    }
+}
+
+/* =====================================================================
+ * rehash: Rebuilds the table (bigger, or same size to drop tombstones)
+ * =====================================================================
+ * Uses the hash stored in each entry, keys are just moved over.
+ * ===================================================================== */
+static void rehash(hash_map_t* map, unsigned new_capacity) {
+    unsigned oldcap = map->capacity;
+    hash_entry_t* oldtab = map->table;
+    unsigned char* oldctrl = map->ctrl;
+
+    swiss_init(map, new_capacity);
+
+    for (unsigned i = 0; i < oldcap; ++i) {
+        if (oldctrl[i] & 0x80)
+            continue;  // EMPTY or DELETED
+        unsigned idx = find_free(map, oldtab[i].hash);
+        set_ctrl(map, idx, h2(oldtab[i].hash));
+        map->table[idx] = oldtab[i];
+        map->length++;
+    }
+
+    free(oldtab);
+    free(oldctrl);
+}
+
+void* swiss_get(hash_map_t* map, const char* key, unsigned long long h) {
+    long idx = find_index(map, key, h);
+    return idx < 0 ? NULL : map->table[idx].value;
+}
+
+void swiss_put(hash_map_t* map, const char* key, unsigned long long h, void* value) {
+    long found = find_index(map, key, h);
+    if (found >= 0) {
+        map->table[found].value = value;
+        return;
+    }
+
+    if (map->length + map->tombstones + 1 > max_load(map->capacity)) {
+        // Mostly tombstones? Clean up in place. Otherwise double.
+        if (map->length * 2 < max_load(map->capacity))
+            rehash(map, map->capacity);
+        else
+            rehash(map, map->capacity << 1);
+    }
+
+    unsigned idx = find_free(map, h);
+    if (map->ctrl[idx] == CTRL_DELETED)
+        map->tombstones--;
+    set_ctrl(map, idx, h2(h));
+    entry_store_key(map, &map->table[idx], key);
+    map->table[idx].value = value;
+    map->table[idx].hash = h;
+    map->length++;
+}
+
+void swiss_delete(hash_map_t* map, const char* key, unsigned long long h) {
+    long found = find_index(map, key, h);
+    if (found < 0)
+        return;
+
+    unsigned idx = (unsigned)found;
+    entry_release_key(map, &map->table[idx]);
+
+    // If the group starting here already has an EMPTY slot, no probe ever
+    // walked past this slot, so it can go straight back to EMPTY.
+    // Otherwise a tombstone keeps later keys in the chain reachable.
+    unsigned mask = map->capacity - 1;
+    unsigned before = (idx - SWISS_GROUP_WIDTH) & mask;
+    unsigned empty_after = group_match_empty(map->ctrl + idx);
+    unsigned empty_before = group_match_empty(map->ctrl + before);
+    int lead = empty_after ? __builtin_ctz(empty_after) : SWISS_GROUP_WIDTH;
+    int trail = empty_before ? __builtin_clz(empty_before << 16) : SWISS_GROUP_WIDTH;
+
+    if (lead + trail < SWISS_GROUP_WIDTH) {
+        set_ctrl(map, idx, CTRL_EMPTY);
+    } else {
+        set_ctrl(map, idx, CTRL_DELETED);
+        map->tombstones++;
+    }
+    map->length--;
+}
@@ -0,0 +1,24 @@
+#ifndef C_IMPLEMENTATION_SWISS_TABLE_H
+#define C_IMPLEMENTATION_SWISS_TABLE_H
+
+#include "hash_set.h"
+
+// Internal backend used by hash_set.cpp when map->ctrl != NULL.
+// Users should only call the hash_map_* functions from hash_set.h.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SWISS_GROUP_WIDTH 16
+
+    void swiss_init(hash_map_t* map, unsigned capacity);
+    void* swiss_get(hash_map_t* map, const char* key, unsigned long long h);
+    void swiss_put(hash_map_t* map, const char* key, unsigned long long h, void* value);
+    void swiss_delete(hash_map_t* map, const char* key, unsigned long long h);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
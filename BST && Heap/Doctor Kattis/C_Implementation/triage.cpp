@@ -0,0 +1,265 @@
+/* =====================================================================
+ * TRIAGE - the clinic state behind the four Doctor Kattis commands
+ * =====================================================================
+ *
+ * Two structures, always kept in sync:
+ *   dict  - hash map, patient name -> Patient*  (find a patient by name)
+ *   queue - who is next: highest severity first, then earliest arrival
+ *
+ * The queue is one of:
+ *   TRIAGE_BUCKETS - bucket queue (bucket_queue.cpp), O(1) per operation,
+ *                    but only for severities in [0, BUCKET_QUEUE_SIZE)
+ *   TRIAGE_RBTREE  - red-black tree (rbtree_template.h), O(log n), any int
+ *   TRIAGE_PAIRING - pairing heap (pairing_heap.cpp), any int, O(1)
+ *                    admit and bump, O(log n) amortized discharge / next
+ *   TRIAGE_RBTREE_POOL - the red-black tree again, but with its nodes in
+ *                    one array (rbtree_pool.h); compacted when it gets
+ *                    mostly empty
+ *
+ * In bucket mode the first severity that doesn't fit moves every patient
+ * into the tree and we stay in tree mode from then on.
+ *
+ * LOOKING AT THE LINE (commands 4 and 5) - nothing is removed:
+ *   top k      - tree: in-order walk from the leftmost node, O(k) after
+ *                O(1) to find it; buckets / pairing: best first walks
+ *   position   - O(log n) everywhere: both red-black trees keep subtree
+ *                sizes. Buckets and the pairing heap have no order
+ *                that can count, so the first position query builds a
+ *                RANK INDEX next to them - a ranked pooled tree in
+ *                t->pool, the same one TRIAGE_RBTREE_POOL uses as its
+ *                queue - and every insert / remove keeps it in sync
+ *                after that. So admits and bumps there stay O(1) until
+ *                somebody asks for a position, O(log n) from then on.
+ * ===================================================================== */
+
+#include "triage.h"
+#include <string.h>
+
+int compare_patients(const Patient* a, const Patient* b) {
+    if (a->severity != b->severity)
+        return a->severity > b->severity ? -1 : 1;  // higher severity first
+    return a->arrival < b->arrival ? -1 : (a->arrival > b->arrival);
+}
+
+triage_t* triage_create(triage_mode_t mode) {
+    triage_t* t = new triage_t;
+    t->mode = mode;
+    t->buckets = mode == TRIAGE_BUCKETS ? bucket_queue_create() : NULL;
+    t->tree = new PatientTree();
+    t->heap = mode == TRIAGE_PAIRING ? pairing_heap_create(compare_patients) : NULL;
+    t->pool = mode == TRIAGE_RBTREE_POOL ? new PatientPoolTree() : NULL;
+    t->dict = init_hash_map();
+    t->arrival = 0;
+    return t;
+}
+
+static void tree_insert(triage_t* t, Patient* p) {
+    p->tree_node = t->tree->insert({priority_key(p->severity, p->arrival), p});
+}
+
+static void update_pool_node(const QueueEntry& e, uint32_t index) {
+    e.patient->pool_node = index;
+}
+
+// The pooled tree, if there is one: the queue in TRIAGE_RBTREE_POOL, the
+// rank index in TRIAGE_BUCKETS / TRIAGE_PAIRING (see triage_count_before)
+static void pool_insert(triage_t* t, Patient* p) {
+    if (t->pool)
+        p->pool_node = t->pool->insert({priority_key(p->severity, p->arrival), p});
+}
+
+static void pool_remove(triage_t* t, Patient* p) {
+    if (t->pool)
+        t->pool->erase(p->pool_node);
+}
+
+// The free list already reuses slots, this gives the memory back after a
+// big drain. Only when 3/4 of the pool is free, so it stays O(1) amortized.
+static void maybe_compact_pool(triage_t* t) {
+    if (t->pool->pool_size() >= 4096 && t->pool->size() < t->pool->pool_size() / 4)
+        t->pool->compact(update_pool_node);
+}
+
+int triage_mode_from_name(const char* name, triage_mode_t* mode) {
+    if (strcmp(name, "buckets") == 0) *mode = TRIAGE_BUCKETS;
+    else if (strcmp(name, "rbtree") == 0) *mode = TRIAGE_RBTREE;
+    else if (strcmp(name, "rbpool") == 0) *mode = TRIAGE_RBTREE_POOL;
+    else if (strcmp(name, "pairing") == 0) *mode = TRIAGE_PAIRING;
+    else return -1;
+    return 0;
+}
+
+// Empties the bucket queue into the tree (best patient first) and stays in tree mode
+static void switch_to_tree(triage_t* t) {
+    while (BucketNode* top = bucket_queue_top(t->buckets)) {
+        bucket_queue_remove(t->buckets, top);
+        tree_insert(t, top->data);
+    }
+    bucket_queue_free(t->buckets);
+    t->buckets = NULL;
+    t->mode = TRIAGE_RBTREE;
+    delete t->pool;  // the tree counts by itself, no rank index needed
+    t->pool = NULL;
+}
+
+static void queue_insert(triage_t* t, Patient* p) {
+    if (t->mode == TRIAGE_BUCKETS && !bucket_queue_fits(p->severity))
+        switch_to_tree(t);
+
+    if (t->mode == TRIAGE_BUCKETS) {
+        p->link.severity = p->severity;
+        p->link.arrival = p->arrival;  // a re-admit changes it too
+        bucket_queue_insert(t->buckets, &p->link);
+    } else if (t->mode == TRIAGE_PAIRING) {
+        pairing_heap_insert(t->heap, &p->node);
+    } else if (t->mode == TRIAGE_RBTREE) {
+        tree_insert(t, p);
+    }
+    pool_insert(t, p);
+}
+
+static void queue_remove(triage_t* t, Patient* p) {
+    if (t->mode == TRIAGE_BUCKETS)
+        bucket_queue_remove(t->buckets, &p->link);
+    else if (t->mode == TRIAGE_PAIRING)
+        pairing_heap_delete(t->heap, &p->node);
+    else if (t->mode == TRIAGE_RBTREE)
+        t->tree->erase(p->tree_node);
+    pool_remove(t, p);
+}
+
+void triage_admit(triage_t* t, const char* name, int severity) {
+    triage_admit_at(t, name, severity, t->arrival++);
+}
+
+void triage_admit_at(triage_t* t, const char* name, int severity, int arrival) {
+    Patient* p = (Patient*)hash_map_get(t->dict, name);
+    if (p) {
+        // Already waiting: the same patient queues again with the new
+        // severity, as a new arrival. A second Patient would be a ghost -
+        // the dict only finds one of them, so the other could never leave
+        queue_remove(t, p);
+        p->severity = severity;
+        p->arrival = arrival;
+        queue_insert(t, p);
+        return;
+    }
+    p = new Patient(name, severity, arrival);
+    queue_insert(t, p);
+    hash_map_put(t->dict, name, p);
+}
+
+void triage_bump(triage_t* t, const char* name, int increase) {
+    Patient* p = (Patient*)hash_map_get(t->dict, name);
+    if (!p)
+        return;
+    if (t->mode == TRIAGE_PAIRING && increase >= 0) {
+        pool_remove(t, p);  // the rank index, if any, is keyed on the old severity
+        p->severity += increase;  // only more urgent, so no need to take them out first
+        pairing_heap_improve(t->heap, &p->node);
+        pool_insert(t, p);
+    } else {
+        queue_remove(t, p);
+        p->severity += increase;
+        queue_insert(t, p);
+    }
+}
+
+void triage_discharge(triage_t* t, const char* name) {
+    Patient* p = (Patient*)hash_map_get(t->dict, name);
+    if (p) {
+        queue_remove(t, p);
+        hash_map_delete(t->dict, name);
+        delete p;
+        if (t->pool)
+            maybe_compact_pool(t);
+    }
+}
+
+const char* triage_next(triage_t* t) {
+    Patient* p = triage_top(t);
+    return p ? p->name.c_str() : NULL;
+}
+
+Patient* triage_top(triage_t* t) {
+    Patient* p;
+    if (t->mode == TRIAGE_BUCKETS) {
+        BucketNode* top = bucket_queue_top(t->buckets);
+        p = top ? top->data : NULL;
+    } else if (t->mode == TRIAGE_PAIRING) {
+        p = pairing_heap_min(t->heap);
+    } else if (t->mode == TRIAGE_RBTREE_POOL) {
+        const QueueEntry* top = t->pool->min();
+        p = top ? top->patient : NULL;
+    } else {
+        const QueueEntry* top = t->tree->min();
+        p = top ? top->patient : NULL;
+    }
+    return p;
+}
+
+typedef struct {
+    void (*fn)(Patient* p, void* ctx);
+    void* ctx;
+} top_k_visitor_t;
+
+static void visit_bucket_node(BucketNode* node, void* v) {
+    top_k_visitor_t* visitor = (top_k_visitor_t*)v;
+    visitor->fn(node->data, visitor->ctx);
+}
+
+void triage_top_k(triage_t* t, int k, void (*fn)(Patient* p, void* ctx), void* ctx) {
+    if (t->mode == TRIAGE_BUCKETS) {
+        top_k_visitor_t visitor = {fn, ctx};
+        bucket_queue_top_k(t->buckets, k, visit_bucket_node, &visitor);
+    } else if (t->mode == TRIAGE_PAIRING) {
+        pairing_heap_top_k(t->heap, k, fn, ctx);
+    } else if (t->mode == TRIAGE_RBTREE_POOL) {
+        for (uint32_t n = t->pool->first(); n && k > 0; n = t->pool->next(n), k--)
+            fn(t->pool->value(n).patient, ctx);
+    } else {
+        for (PatientTree::Node* n = t->tree->first(); n && k > 0; n = PatientTree::next(n), k--)
+            fn(n->value.patient, ctx);
+    }
+}
+
+Patient* triage_find(triage_t* t, const char* name) {
+    return (Patient*)hash_map_get(t->dict, name);
+}
+
+static void add_to_rank_index(const char*, void* value, void* ctx) {
+    pool_insert((triage_t*)ctx, (Patient*)value);
+}
+
+int triage_count_before(triage_t* t, const Patient* x) {
+    QueueEntry key = {priority_key(x->severity, x->arrival), NULL};
+    if (t->mode == TRIAGE_RBTREE)
+        return (int)t->tree->count_less(key);
+    if (!t->pool) {
+        // buckets / pairing: the first position query builds the rank index, O(n log n) once
+        t->pool = new PatientPoolTree();
+        hash_map_foreach(t->dict, add_to_rank_index, t);  // dict holds exactly the waiting patients
+    }
+    return (int)t->pool->count_less(key);
+}
+
+int triage_position(triage_t* t, const char* name) {
+    Patient* p = triage_find(t, name);
+    return p ? triage_count_before(t, p) + 1 : 0;
+}
+
+static void delete_patient(const char*, void* value, void*) {
+    delete (Patient*)value;
+}
+
+void triage_free(triage_t* t) {
+    hash_map_foreach(t->dict, delete_patient, NULL);  // every patient is in dict exactly once
+    free_hash_map(t->dict);
+    delete t->tree;
+    if (t->buckets)
+        bucket_queue_free(t->buckets);
+    if (t->heap)
+        pairing_heap_free(t->heap);
+    delete t->pool;
+    delete t;
+}
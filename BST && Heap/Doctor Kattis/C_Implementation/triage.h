@@ -0,0 +1,53 @@
+#ifndef C_IMPLEMENTATION_TRIAGE_H
+#define C_IMPLEMENTATION_TRIAGE_H
+
+#include "patient.h"
+#include "hash_set.h"
+#include "bucket_queue.h"
+#include "pairing_heap.h"
+
+typedef enum {
+    TRIAGE_BUCKETS, // bucket queue while severities fit, then switches to TRIAGE_RBTREE by itself
+    TRIAGE_RBTREE,
+    TRIAGE_PAIRING, // pairing heap, any int, cheapest bumps
+    TRIAGE_RBTREE_POOL // red-black tree in one array with 32-bit links
+} triage_mode_t;
+
+// The whole clinic: who is waiting (ordered queue) + name -> Patient*
+typedef struct {
+    triage_mode_t mode;
+    BucketQueue* buckets; // used in TRIAGE_BUCKETS
+    PatientTree* tree;    // used in TRIAGE_RBTREE
+    PairingHeap* heap;    // used in TRIAGE_PAIRING
+    PatientPoolTree* pool; // used in TRIAGE_RBTREE_POOL; in BUCKETS / PAIRING the rank index, once positions are asked for
+    hash_map_t* dict;
+    int arrival;          // next arrival number
+} triage_t;
+
+triage_t* triage_create(triage_mode_t mode);
+
+int triage_mode_from_name(const char* name, triage_mode_t* mode);    // "rbtree" etc., -1 if name isn't a backend
+
+void triage_admit(triage_t* t, const char* name, int severity);      // command 0, a waiting name is queued again
+
+void triage_admit_at(triage_t* t, const char* name, int severity, int arrival); // arrival chosen by the caller
+
+void triage_bump(triage_t* t, const char* name, int increase);       // command 1
+
+void triage_discharge(triage_t* t, const char* name);                // command 2
+
+const char* triage_next(triage_t* t);                                // command 3, NULL if empty
+
+Patient* triage_top(triage_t* t);                                    // the patient triage_next names
+
+void triage_top_k(triage_t* t, int k, void (*fn)(Patient* p, void* ctx), void* ctx); // command 4, nothing removed
+
+int triage_position(triage_t* t, const char* name);                  // command 5, 1 = next, 0 = not waiting
+
+Patient* triage_find(triage_t* t, const char* name);
+
+int triage_count_before(triage_t* t, const Patient* x);              // waiting patients ahead of x (x may be elsewhere)
+
+void triage_free(triage_t* t);
+
+#endif
@@ -0,0 +1,314 @@
+// Benchmark: replays one synthetic Doctor Kattis trace through every triage program
+// Usage: ./triage_bench [options] [--program LABEL=COMMAND ...]
+//
+//   --commands N        trace length                                  (default 2000000)
+//   --mix A,B,D,Q       percent of admit, bump, discharge, next       (default 40,20,20,20)
+//   --zipf S            skew of name reuse, 0 = uniform               (default 1.0)
+//   --names U           size of the reused name pool                  (default 100000)
+//   --severity DIST     uniform (0..100), skewed (zipf over 0..4095)
+//                       or wide (0..2e9, no bucket queue)             (default uniform)
+//   --seed N            (default 1)
+//   --runs R            best wall time of R runs                      (default 3)
+//   --emit FILE         only write the trace to FILE and exit
+//   --program L=CMD     a program to compare, stdin = trace. Repeatable. Without any,
+//                       ./C_Implementation (next to this binary) with every --backend
+//
+// Admits usually take a name from the pool, picked with a Zipf distribution, so
+// a few names come back again and again (like frequent patients). Bumps and
+// discharges pick a waiting patient the same way, so the hot names are also the
+// ones that get bumped. Names that are already waiting are replaced by fresh ones,
+// the trace always stays valid.
+//
+// For every program it reports the wall time, commands/s, peak RSS (wait4) and,
+// if liballoc_counter.so sits next to this binary, the number of allocations
+// (LD_PRELOAD, see alloc_counter.cpp). All outputs must be byte-identical to the
+// first program's output.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace std;
+
+struct Options {
+    long long commands = 2000000;
+    int mix[4] = {40, 20, 20, 20};
+    double zipf = 1.0;
+    int names = 100000;
+    string severity = "uniform";
+    unsigned seed = 1;
+    int runs = 3;
+    string emit;
+    vector<pair<string, string>> programs;  // label, command line
+};
+
+// Samples 0..n-1 with P(k) proportional to 1 / (k+1)^s
+class ZipfSampler {
+public:
+    ZipfSampler(int n, double s) : cdf_(n) {
+        double sum = 0;
+        for (int k = 0; k < n; k++) {
+            sum += 1.0 / pow(k + 1, s);
+            cdf_[k] = sum;
+        }
+        for (double& c : cdf_)
+            c /= sum;
+    }
+
+    int operator()(mt19937_64& rng) {
+        double u = uniform_real_distribution<double>(0, 1)(rng);
+        return (int)(lower_bound(cdf_.begin(), cdf_.end(), u) - cdf_.begin());
+    }
+
+private:
+    vector<double> cdf_;
+};
+
+/* =====================================================================
+ * Trace generator
+ * =====================================================================
+ * Keeps the set of waiting names (vector + index map, so removing one
+ * is a swap with the last) to only ever bump / discharge real patients.
+ * ===================================================================== */
+static string generate_trace(const Options& o) {
+    mt19937_64 rng(o.seed);
+    ZipfSampler name_pick(o.names, o.zipf);
+    ZipfSampler skewed_severity(4096, 1.0);
+
+    vector<string> waiting;
+    unordered_map<string, size_t> where;
+    long long fresh = 0;
+
+    auto severity = [&]() -> long long {
+        if (o.severity == "wide") return (long long)(rng() % 2000000000ULL);
+        if (o.severity == "skewed") return skewed_severity(rng);
+        return (long long)(rng() % 101);
+    };
+    // hot names first, any waiting patient if the hot one isn't here
+    auto pick_waiting = [&]() -> size_t {
+        auto it = where.find("p" + to_string(name_pick(rng)));
+        return it != where.end() ? it->second : rng() % waiting.size();
+    };
+    auto remove_waiting = [&](size_t i) {
+        where.erase(waiting[i]);
+        if (i != waiting.size() - 1) {
+            waiting[i] = move(waiting.back());
+            where[waiting[i]] = i;
+        }
+        waiting.pop_back();
+    };
+
+    int total = o.mix[0] + o.mix[1] + o.mix[2] + o.mix[3];
+    string out = to_string(o.commands) + "\n";
+    out.reserve(o.commands * 16);
+
+    for (long long i = 0; i < o.commands; i++) {
+        int r = (int)(rng() % total);
+        int kind = r < o.mix[0] ? 0 : r < o.mix[0] + o.mix[1] ? 1 : r < o.mix[0] + o.mix[1] + o.mix[2] ? 2 : 3;
+        if ((kind == 1 || kind == 2) && waiting.empty())
+            kind = 0;
+
+        if (kind == 0) {
+            string name = "p" + to_string(name_pick(rng));
+            if (where.count(name))
+                name = "n" + to_string(fresh++);  // already waiting: use a new name
+            out += "0 " + name + " " + to_string(severity()) + "\n";
+            where[name] = waiting.size();
+            waiting.push_back(name);
+        } else if (kind == 1) {
+            out += "1 " + waiting[pick_waiting()] + " " + to_string(1 + rng() % 10) + "\n";
+        } else if (kind == 2) {
+            size_t k = pick_waiting();
+            out += "2 " + waiting[k] + "\n";
+            remove_waiting(k);
+        } else {
+            out += "3\n";
+        }
+    }
+    return out;
+}
+
+static bool write_file(const string& path, const string& data) {
+    ofstream f(path, ios::binary);
+    f.write(data.data(), (streamsize)data.size());
+    return (bool)f;
+}
+
+static string read_file(const string& path) {
+    ifstream f(path, ios::binary);
+    stringstream ss;
+    ss << f.rdbuf();
+    return ss.str();
+}
+
+static vector<string> split_words(const string& s) {
+    vector<string> words;
+    istringstream in(s);
+    for (string w; in >> w; )
+        words.push_back(w);
+    return words;
+}
+
+struct RunResult {
+    bool ok = false;
+    double seconds = 0;
+    long peak_rss_kb = 0;
+    long long allocations = -1;
+    string output;
+};
+
+// fork + exec with stdin = trace, stdout = a file; wait4 gives the peak RSS
+static RunResult run_program(const string& command, const string& trace_path,
+                             const string& out_path, const string& counter_lib) {
+    RunResult r;
+    vector<string> words = split_words(command);
+    if (words.empty())
+        return r;
+    string counter_out = out_path + ".allocs";
+    unlink(counter_out.c_str());
+
+    auto start = chrono::steady_clock::now();
+    pid_t pid = fork();
+    if (pid == 0) {
+        int in = open(trace_path.c_str(), O_RDONLY);
+        int out = open(out_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (in < 0 || out < 0) _exit(127);
+        dup2(in, 0);
+        dup2(out, 1);
+        if (!counter_lib.empty()) {
+            setenv("LD_PRELOAD", counter_lib.c_str(), 1);
+            setenv("ALLOC_COUNTER_OUT", counter_out.c_str(), 1);
+        }
+        vector<char*> argv;
+        for (string& w : words)
+            argv.push_back(w.data());
+        argv.push_back(NULL);
+        execvp(argv[0], argv.data());
+        _exit(127);
+    }
+
+    int status = 0;
+    rusage usage = {};
+    if (pid < 0 || wait4(pid, &status, 0, &usage) < 0)
+        return r;
+    r.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    r.ok = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    r.peak_rss_kb = usage.ru_maxrss;  // Linux reports KB
+    r.output = read_file(out_path);
+
+    long long allocations, bytes;
+    FILE* f = fopen(counter_out.c_str(), "r");
+    if (f) {
+        if (fscanf(f, "%lld %lld", &allocations, &bytes) == 2)
+            r.allocations = allocations;
+        fclose(f);
+        unlink(counter_out.c_str());
+    }
+    return r;
+}
+
+static string directory_of(const char* path) {
+    string s = path;
+    size_t slash = s.rfind('/');
+    return slash == string::npos ? "." : s.substr(0, slash);
+}
+
+int main(int argc, char** argv) {
+    Options o;
+    for (int i = 1; i < argc; i++) {
+        string a = argv[i];
+        bool has_value = i + 1 < argc;
+        if (a == "--commands" && has_value) o.commands = atoll(argv[++i]);
+        else if (a == "--mix" && has_value) sscanf(argv[++i], "%d,%d,%d,%d", &o.mix[0], &o.mix[1], &o.mix[2], &o.mix[3]);
+        else if (a == "--zipf" && has_value) o.zipf = atof(argv[++i]);
+        else if (a == "--names" && has_value) o.names = max(1, atoi(argv[++i]));
+        else if (a == "--severity" && has_value) o.severity = argv[++i];
+        else if (a == "--seed" && has_value) o.seed = (unsigned)atoi(argv[++i]);
+        else if (a == "--runs" && has_value) o.runs = max(1, atoi(argv[++i]));
+        else if (a == "--emit" && has_value) o.emit = argv[++i];
+        else if (a == "--program" && has_value) {
+            string p = argv[++i];
+            size_t eq = p.find('=');
+            if (eq == string::npos) o.programs.push_back({p, p});
+            else o.programs.push_back({p.substr(0, eq), p.substr(eq + 1)});
+        } else {
+            cerr << "unknown option " << a << " (see the top of triage_bench.cpp)\n";
+            return 1;
+        }
+    }
+    if (o.mix[0] + o.mix[1] + o.mix[2] + o.mix[3] <= 0) {
+        cerr << "--mix must not be all zero\n";
+        return 1;
+    }
+
+    string trace = generate_trace(o);
+    if (!o.emit.empty())
+        return write_file(o.emit, trace) ? 0 : 1;
+
+    string dir = directory_of(argv[0]);
+    if (o.programs.empty())
+        for (const char* backend : {"buckets", "rbtree", "rbpool", "pairing"})
+            o.programs.push_back({backend, dir + "/C_Implementation --backend " + backend});
+
+    string counter_lib = dir + "/liballoc_counter.so";
+    if (access(counter_lib.c_str(), R_OK) != 0)
+        counter_lib.clear();
+    else if (counter_lib[0] != '/')
+        counter_lib = string(getcwd(NULL, 0)) + "/" + counter_lib;  // LD_PRELOAD wants a real path
+
+    char trace_path[] = "/tmp/triage_bench_XXXXXX";
+    int fd = mkstemp(trace_path);
+    if (fd < 0 || !write_file(trace_path, trace)) {
+        cerr << "can't write the trace\n";
+        return 1;
+    }
+    close(fd);
+    string out_path = string(trace_path) + ".out";
+
+    cout << o.commands << " commands, mix " << o.mix[0] << "/" << o.mix[1] << "/" << o.mix[2] << "/" << o.mix[3]
+         << ", zipf " << o.zipf << " over " << o.names << " names, severity " << o.severity << "\n\n";
+    cout << left << setw(14) << "program" << right << setw(10) << "seconds" << setw(12) << "Mcmd/s"
+         << setw(14) << "allocations" << setw(12) << "peak MB" << "  output\n";
+
+    string reference;
+    int failures = 0;
+    for (size_t p = 0; p < o.programs.size(); p++) {
+        RunResult best;
+        for (int run = 0; run < o.runs; run++) {
+            RunResult r = run_program(o.programs[p].second, trace_path, out_path, counter_lib);
+            if (!r.ok) { best = r; break; }
+            if (run == 0 || r.seconds < best.seconds) best = r;
+        }
+
+        string verdict;
+        if (!best.ok) verdict = "FAILED";
+        else if (p == 0) { reference = best.output; verdict = "reference"; }
+        else verdict = best.output == reference ? "same" : "DIFFERENT";
+        if (verdict == "FAILED" || verdict == "DIFFERENT")
+            failures++;
+
+        cout << left << setw(14) << o.programs[p].first << right << fixed << setprecision(3)
+             << setw(10) << best.seconds << setprecision(2) << setw(12) << o.commands / best.seconds / 1e6
+             << setw(14) << (best.allocations >= 0 ? to_string(best.allocations) : string("-"))
+             << setprecision(1) << setw(12) << best.peak_rss_kb / 1024.0 << "  " << verdict << "\n";
+    }
+
+    unlink(trace_path);
+    unlink(out_path.c_str());
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,205 @@
+// Load generator for triage_server: throughput and latency percentiles
+// Usage: ./triage_loadgen SOCKET_PATH [connections] [pipeline_depth] [commands] [--check]
+//        defaults: 4 connections, 32 commands in flight each, 1000000 commands in total
+//
+// Every connection is a thread that keeps pipeline_depth commands in flight:
+// it writes them in one go, reads the answers, and refills. A command's latency
+// is from the write that carried it to the read that brought its answer back.
+// Each connection admits its own names ("c<conn>_<n>"), bumps / discharges
+// names it admitted, and asks what a dashboard would now and then:
+//   40% admit, 20% bump, 20% discharge, 10% next, 5% top 1..10, 5% position of one of its names
+// --check: every admit / bump / discharge has to be answered with OK, no query with ERR
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace std;
+using Clock = chrono::steady_clock;
+
+struct ConnectionResult {
+    vector<uint32_t> latency_ns;
+    long long errors = 0;
+    bool failed = false;
+};
+
+static int connect_to(const char* path) {
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+    if (fd < 0 || connect(fd, (sockaddr*)&addr, sizeof(addr)) < 0) {
+        perror("connect");
+        if (fd >= 0) close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static bool write_all(int fd, const string& s) {
+    size_t done = 0;
+    while (done < s.size()) {
+        ssize_t n = write(fd, s.data() + done, s.size() - done);
+        if (n <= 0) return false;
+        done += (size_t)n;
+    }
+    return true;
+}
+
+static void run_connection(const char* path, int id, long long commands, int depth, bool check,
+                           ConnectionResult* result) {
+    int fd = connect_to(path);
+    if (fd < 0) {
+        result->failed = true;
+        return;
+    }
+
+    mt19937_64 rng(1234 + id);
+    vector<string> admitted;  // names this connection may bump / discharge
+    long long next_name = 0;
+    result->latency_ns.reserve(commands);
+
+    string batch, in;
+    vector<const char*> expect;  // --check: the answer has to be this, or anything but ERR (NULL)
+    char buf[64 * 1024];
+
+    for (long long sent = 0; sent < commands; ) {
+        int n = (int)min<long long>(depth, commands - sent);
+        batch.clear();
+        expect.clear();
+        for (int i = 0; i < n; i++) {
+            unsigned r = rng() % 100;
+            if (r < 40 || admitted.empty()) {
+                string name = "c" + to_string(id) + "_" + to_string(next_name++);
+                batch += "0 " + name + " " + to_string(rng() % 100) + "\n";
+                admitted.push_back(name);
+                expect.push_back("OK");
+            } else if (r < 60) {
+                batch += "1 " + admitted[rng() % admitted.size()] + " " + to_string(rng() % 10) + "\n";
+                expect.push_back("OK");
+            } else if (r < 80) {
+                size_t k = rng() % admitted.size();
+                batch += "2 " + admitted[k] + "\n";
+                admitted[k] = admitted.back();
+                admitted.pop_back();
+                expect.push_back("OK");
+            } else if (r < 90) {
+                batch += "3\n";
+                expect.push_back(NULL);
+            } else if (r < 95) {
+                batch += "4 " + to_string(1 + rng() % 10) + "\n";
+                expect.push_back(NULL);
+            } else {
+                batch += "5 " + admitted[rng() % admitted.size()] + "\n";
+                expect.push_back(NULL);
+            }
+        }
+
+        auto start = Clock::now();
+        if (!write_all(fd, batch)) {
+            result->failed = true;
+            break;
+        }
+
+        // read until all n answers are back, timestamp each as its line completes
+        int answered = 0;
+        size_t line_start = 0;
+        in.clear();
+        while (answered < n) {
+            ssize_t got = read(fd, buf, sizeof(buf));
+            if (got <= 0) {
+                result->failed = true;
+                break;
+            }
+            in.append(buf, (size_t)got);
+            auto now = Clock::now();
+            uint32_t ns = (uint32_t)min<long long>(
+                chrono::duration_cast<chrono::nanoseconds>(now - start).count(), UINT32_MAX);
+
+            size_t nl;
+            while (answered < n && (nl = in.find('\n', line_start)) != string::npos) {
+                if (check) {
+                    const char* want = expect[answered];
+                    bool is = in.compare(line_start, nl - line_start, want ? want : "ERR") == 0;
+                    if (want ? !is : is)
+                        result->errors++;
+                }
+                result->latency_ns.push_back(ns);
+                answered++;
+                line_start = nl + 1;
+            }
+        }
+        if (result->failed)
+            break;
+        sent += n;
+    }
+    close(fd);
+}
+
+static double percentile_us(const vector<uint32_t>& sorted, double p) {
+    if (sorted.empty()) return 0;
+    size_t i = (size_t)(p * (sorted.size() - 1));
+    return sorted[i] / 1000.0;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        cerr << "usage: " << argv[0] << " SOCKET_PATH [connections] [pipeline_depth] [commands] [--check]\n";
+        return 1;
+    }
+    bool check = false;
+    vector<char*> args;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--check") == 0) check = true;
+        else args.push_back(argv[i]);
+    }
+    const char* path = args[0];
+    int connections = args.size() > 1 ? atoi(args[1]) : 4;
+    int depth = args.size() > 2 ? atoi(args[2]) : 32;
+    long long commands = args.size() > 3 ? atoll(args[3]) : 1000000;
+    if (connections < 1) connections = 1;
+    if (depth < 1) depth = 1;
+
+    vector<ConnectionResult> results(connections);
+    vector<thread> threads;
+    long long per_connection = commands / connections;
+
+    auto start = Clock::now();
+    for (int i = 0; i < connections; i++)
+        threads.emplace_back(run_connection, path, i, per_connection, depth, check, &results[i]);
+    for (thread& t : threads)
+        t.join();
+    double seconds = chrono::duration<double>(Clock::now() - start).count();
+
+    vector<uint32_t> all;
+    long long errors = 0;
+    for (ConnectionResult& r : results) {
+        if (r.failed) {
+            cerr << "a connection failed\n";
+            return 1;
+        }
+        all.insert(all.end(), r.latency_ns.begin(), r.latency_ns.end());
+        errors += r.errors;
+    }
+    sort(all.begin(), all.end());
+
+    cout << fixed << setprecision(1);
+    cout << "connections " << connections << ", depth " << depth << ", commands " << all.size() << "\n";
+    cout << "throughput  " << all.size() / seconds / 1e3 << " kcmd/s\n";
+    cout << "latency us  p50 " << percentile_us(all, 0.50) << "  p99 " << percentile_us(all, 0.99)
+         << "  p99.9 " << percentile_us(all, 0.999) << "  max " << (all.empty() ? 0 : all.back() / 1000.0) << "\n";
+    if (check)
+        cout << "errors      " << errors << "\n";
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,420 @@
+/* =====================================================================
+ * TRIAGE SERVER - the clinic as a long running process (Linux only)
+ * =====================================================================
+ *
+ * ./triage_server /tmp/triage.sock [--backend buckets|rbtree|rbpool|pairing]
+ *                 [--data DIR [--fsync] [--snapshot-every N]]
+ *
+ * Keeps one triage_t in memory for as long as it runs and takes the same
+ * commands as main.cpp, one per line, over a Unix domain socket:
+ *
+ *   0 NAME SEVERITY     ->  OK
+ *   1 NAME INCREASE     ->  OK
+ *   2 NAME              ->  OK
+ *   3                   ->  NAME   (or "The clinic is empty")
+ *   4 K                 ->  NAME NAME ...  the next K, best first, on ONE
+ *                           line (or "The clinic is empty")
+ *   5 NAME              ->  NAME's place in line, 1 = next, 0 = not waiting
+ *
+ * 4 and 5 are for dashboards polling while the commands stream in; they
+ * only look, like 3, and are never journaled.
+ *
+ * Every command gets exactly one line back, in order, so a client can
+ * PIPELINE: send many commands without waiting, then read the answers.
+ *
+ * ONE THREAD, EPOLL:
+ * All connections share one triage_t, so there is nothing to gain from
+ * threads here - one loop waits on every socket with epoll and handles
+ * whatever is ready. Commands from different clients interleave in the
+ * order their bytes arrive.
+ *
+ * BATCHING:
+ * A read takes up to 64KB, every complete line in it is executed, and
+ * all the answers go out with ONE write. A client with 100 commands in
+ * flight costs 2 system calls, not 200. If the socket can't take the
+ * whole answer we keep the rest and ask epoll for EPOLLOUT. A client
+ * that doesn't read its answers stops being read (backpressure).
+ * A client may shut down its sending side after the last command: we
+ * stop reading and close only once every answer has been written.
+ *
+ * Admitting a name that is already waiting queues that patient again
+ * with the new severity (triage_admit), it doesn't add a second one.
+ *
+ * PERSISTENCE (--data DIR):
+ * Without it the clinic is gone when the process is. With it, every
+ * command that changes the clinic is journaled (triage_store.cpp) and
+ * the journal is written BEFORE the answers of that round go out, so
+ * whatever a client saw "OK" for survives a crash ("3" only looks, it
+ * is never journaled).
+ * The journal reaches the OS before the answers; with --fsync it reaches
+ * the disk (survives a power cut too, costs one fdatasync per round).
+ * Every --snapshot-every journaled commands (default 1000000), and on a
+ * clean shutdown, the whole clinic is written as a snapshot and the
+ * journal starts over, so a restart never replays more than that.
+ *
+ * SIGINT / SIGTERM stop the loop and remove the socket file.
+ * ===================================================================== */
+
+#include "triage.h"
+#include "triage_store.h"
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace std;
+
+#define READ_CHUNK (64 * 1024)
+#define MAX_LINE 4096                 // a longer line means a broken client
+#define MAX_PENDING_OUT (4 << 20)     // stop reading a client with this much unread output
+#define MAX_EVENTS 64
+
+struct Connection {
+    int fd;
+    string in;        // bytes read but not executed yet (a partial line)
+    string out;       // answers not written yet
+    size_t out_pos = 0;
+    unsigned events = 0;  // what epoll currently watches
+    bool eof = false;     // client shut down its side: nothing more to read, answers still owed
+};
+
+static volatile sig_atomic_t stop_requested = 0;
+static triage_store_t* store = NULL;  // --data, NULL = keep nothing
+
+static void on_signal(int) {
+    stop_requested = 1;
+}
+
+// Value of --NAME VALUE, or NULL
+static const char* option(int argc, char** argv, const char* name) {
+    for (int i = 1; i + 1 < argc; i++)
+        if (strcmp(argv[i], name) == 0)
+            return argv[i + 1];
+    return NULL;
+}
+
+static bool has_flag(int argc, char** argv, const char* name) {
+    for (int i = 1; i < argc; i++)
+        if (strcmp(argv[i], name) == 0)
+            return true;
+    return false;
+}
+
+// Parses an int at *p and moves *p past it. Returns false if there is none
+static bool parse_int(char** p, int* value) {
+    char* end;
+    long v = strtol(*p, &end, 10);
+    if (end == *p)
+        return false;
+    *value = (int)v;
+    *p = end;
+    return true;
+}
+
+// Cuts the next word out of the line: NUL terminates it in place
+static char* next_word(char** p) {
+    char* s = *p;
+    while (*s == ' ' || *s == '\t') s++;
+    if (!*s)
+        return NULL;
+    char* e = s;
+    while (*e && *e != ' ' && *e != '\t') e++;
+    if (*e) *e++ = '\0';
+    *p = e;
+    return s;
+}
+
+static void append_name(Patient* p, void* ctx) {
+    string* out = (string*)ctx;
+    if (!out->empty() && out->back() != '\n')
+        *out += ' ';
+    *out += p->name;
+}
+
+// Runs one command line (already NUL terminated, no '\n') and appends the answer
+static void execute(triage_t* clinic, char* line, string& out) {
+    char* p = line;
+    int cmd, value;
+    if (!parse_int(&p, &cmd)) {
+        out += "ERR\n";
+        return;
+    }
+
+    if (cmd == 3) {
+        const char* next = triage_next(clinic);
+        out += next ? next : "The clinic is empty";
+        out += '\n';
+        return;
+    }
+    if (cmd == 4) {
+        if (!parse_int(&p, &value))
+            out += "ERR";
+        else if (value > 0 && !triage_top(clinic))
+            out += "The clinic is empty";
+        else
+            triage_top_k(clinic, value, append_name, &out);
+        out += '\n';
+        return;
+    }
+
+    char* name = next_word(&p);
+    if (!name || cmd < 0 || cmd > 5 || (cmd < 2 && !parse_int(&p, &value))) {
+        out += "ERR\n";
+        return;
+    }
+    if (cmd == 5) {
+        out += to_string(triage_position(clinic, name));
+        out += '\n';
+        return;
+    }
+    if (cmd == 0) {
+        triage_admit(clinic, name, value);
+        if (store) triage_store_log_admit(store, name, value);
+    } else if (cmd == 1) {
+        triage_bump(clinic, name, value);
+        if (store) triage_store_log_bump(store, name, value);
+    } else {
+        triage_discharge(clinic, name);
+        if (store) triage_store_log_discharge(store, name);
+    }
+    out += "OK\n";
+}
+
+// Executes every complete line in c->in, keeps the unfinished tail
+static bool execute_lines(triage_t* clinic, Connection* c) {
+    size_t start = 0;
+    while (true) {
+        size_t nl = c->in.find('\n', start);
+        if (nl == string::npos)
+            break;
+        c->in[nl] = '\0';
+        if (nl > start && c->in[nl - 1] == '\r')
+            c->in[nl - 1] = '\0';
+        execute(clinic, &c->in[start], c->out);
+        start = nl + 1;
+    }
+    c->in.erase(0, start);
+    return c->in.size() <= MAX_LINE;
+}
+
+// The journal goes out before any answer does. A journal that can't be
+// written is fatal: carrying on would acknowledge commands we can't keep
+static bool flush_journal() {
+    if (!store || triage_store_flush(store) == 0)
+        return true;
+    perror("triage_store: journal write");
+    stop_requested = 1;
+    return false;
+}
+
+// Writes as much pending output as the socket takes. false = connection broken
+static bool flush_output(Connection* c) {
+    while (c->out_pos < c->out.size()) {
+        ssize_t n = write(c->fd, c->out.data() + c->out_pos, c->out.size() - c->out_pos);
+        if (n > 0) {
+            c->out_pos += (size_t)n;
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        } else {
+            return false;
+        }
+    }
+    if (c->out_pos == c->out.size()) {
+        c->out.clear();
+        c->out_pos = 0;
+    }
+    return true;
+}
+
+// Read while the client keeps up with its answers, ask for EPOLLOUT while some are pending
+static void update_interest(int epfd, Connection* c) {
+    size_t pending = c->out.size() - c->out_pos;
+    unsigned events = 0;
+    if (pending < MAX_PENDING_OUT && !c->eof)
+        events |= EPOLLIN;
+    if (pending > 0)
+        events |= EPOLLOUT;
+    if (events == c->events)
+        return;
+    epoll_event ev = {};
+    ev.events = events;
+    ev.data.ptr = c;
+    epoll_ctl(epfd, EPOLL_CTL_MOD, c->fd, &ev);
+    c->events = events;
+}
+
+// false = close the connection
+static bool handle_readable(triage_t* clinic, Connection* c) {
+    char buf[READ_CHUNK];
+    while (true) {
+        ssize_t n = read(c->fd, buf, sizeof(buf));
+        if (n > 0) {
+            c->in.append(buf, (size_t)n);
+            if (!execute_lines(clinic, c))
+                return false;
+            if (c->out.size() - c->out_pos >= MAX_PENDING_OUT)
+                break;  // let the client catch up first
+        } else if (n == 0) {
+            c->eof = true;  // done sending, but may still be reading: stay until the answers are out
+            break;
+        } else if (errno == EINTR) {
+            continue;
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            break;
+        } else {
+            return false;
+        }
+    }
+    if (!flush_journal())
+        return false;
+    return flush_output(c);  // one write for everything this round produced
+}
+
+// A half-closed client is finished once its last answer is written
+static bool finished(Connection* c) {
+    return c->eof && c->out_pos == c->out.size();
+}
+
+static int listen_on(const char* path) {
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        perror("socket");
+        return -1;
+    }
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "socket path too long: %s\n", path);
+        close(fd);
+        return -1;
+    }
+    strcpy(addr.sun_path, path);
+    unlink(path);  // a stale file from a previous run would make bind fail
+    if (bind(fd, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(fd, SOMAXCONN) < 0) {
+        perror("bind/listen");
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int main(int argc, char** argv) {
+    const char* backend = option(argc, argv, "--backend");
+    triage_mode_t mode = TRIAGE_BUCKETS;
+    if (argc < 2 || argv[1][0] == '-' || (has_flag(argc, argv, "--backend") && !backend) ||
+        (backend && triage_mode_from_name(backend, &mode) != 0)) {
+        fprintf(stderr, "usage: %s SOCKET_PATH [--backend buckets|rbtree|rbpool|pairing]\n"
+                        "       [--data DIR [--fsync] [--snapshot-every N]]\n", argv[0]);
+        return 1;
+    }
+    const char* path = argv[1];
+    const char* data_dir = option(argc, argv, "--data");
+    const char* every = option(argc, argv, "--snapshot-every");
+    long long snapshot_every = every ? atoll(every) : 1000000;
+    if (snapshot_every < 1) snapshot_every = 1;
+
+    triage_t* clinic = triage_create(mode);
+    if (data_dir) {
+        store = triage_store_open(data_dir, clinic, has_flag(argc, argv, "--fsync"));
+        if (!store) {
+            triage_free(clinic);
+            return 1;
+        }
+    }
+
+    struct sigaction sa = {};
+    sa.sa_handler = on_signal;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    signal(SIGPIPE, SIG_IGN);  // a client leaving mid-write is an error code, not a crash
+
+    int listen_fd = listen_on(path);
+    if (listen_fd < 0) {
+        triage_store_close(store);
+        triage_free(clinic);
+        return 1;
+    }
+
+    int epfd = epoll_create1(EPOLL_CLOEXEC);
+    epoll_event ev = {};
+    ev.events = EPOLLIN;
+    ev.data.ptr = NULL;  // NULL = the listening socket
+    epoll_ctl(epfd, EPOLL_CTL_ADD, listen_fd, &ev);
+
+    unordered_map<int, Connection*> connections;
+    epoll_event events[MAX_EVENTS];
+
+    while (!stop_requested) {
+        int n = epoll_wait(epfd, events, MAX_EVENTS, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            perror("epoll_wait");
+            break;
+        }
+
+        for (int i = 0; i < n; i++) {
+            Connection* c = (Connection*)events[i].data.ptr;
+
+            if (!c) {
+                int fd;
+                while ((fd = accept4(listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+                    c = new Connection();
+                    c->fd = fd;
+                    c->events = EPOLLIN;
+                    epoll_event cev = {};
+                    cev.events = EPOLLIN;
+                    cev.data.ptr = c;
+                    epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &cev);
+                    connections[fd] = c;
+                }
+                continue;
+            }
+
+            bool alive = !(events[i].events & EPOLLERR);
+            if (alive && (events[i].events & EPOLLOUT))
+                alive = flush_output(c);
+            if (alive && !c->eof && (events[i].events & (EPOLLIN | EPOLLHUP)))
+                alive = handle_readable(clinic, c);
+            if (alive && finished(c))
+                alive = false;
+
+            if (alive) {
+                update_interest(epfd, c);
+            } else {
+                epoll_ctl(epfd, EPOLL_CTL_DEL, c->fd, NULL);
+                close(c->fd);
+                connections.erase(c->fd);
+                delete c;
+            }
+        }
+
+        if (store && triage_store_journal_length(store) >= snapshot_every &&
+            triage_store_snapshot(store, clinic) != 0)
+            perror("triage_store: snapshot");  // nothing lost: the old snapshot + journal, or a journal reset the next flush retries
+    }
+
+    for (auto& [fd, c] : connections) {
+        close(fd);
+        delete c;
+    }
+    close(epfd);
+    close(listen_fd);
+    unlink(path);
+    if (store) {
+        if (triage_store_snapshot(store, clinic) != 0)
+            perror("triage_store: snapshot");
+        triage_store_close(store);
+    }
+    triage_free(clinic);
+    return 0;
+}
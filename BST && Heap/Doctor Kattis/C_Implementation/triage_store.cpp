@@ -0,0 +1,456 @@
+/* =====================================================================
+ * TRIAGE STORE - surviving a restart (POSIX: mmap, fsync, rename)
+ * =====================================================================
+ *
+ * Two files in one directory:
+ *
+ *   snapshot.bin - every waiting patient + the arrival counter, at some
+ *                  moment. Written rarely, read once at startup.
+ *   journal.bin  - every admit / bump / discharge SINCE that snapshot,
+ *                  appended as they happen.
+ *
+ * state now = snapshot + replay of the journal.
+ *
+ * Replaying only the journal tail is what makes restarts fast: a snapshot
+ * is one mmap and one pass over packed records, however many hours of
+ * commands led to it.
+ *
+ * ARRIVALS need nothing special: the snapshot stores each patient's
+ * arrival and the next arrival number, and replaying admits in journal
+ * order hands out exactly the numbers they got the first time.
+ *
+ * WHICH JOURNAL BELONGS TO WHICH SNAPSHOT - GENERATIONS:
+ * Both files start with a generation number. Taking a snapshot:
+ *   1. write snapshot.tmp (generation g+1), fsync
+ *   2. rename it over snapshot.bin            <- atomic
+ *   3. truncate journal.bin, header g+1, fsync
+ * A crash between 2 and 3 leaves a journal of generation g next to a
+ * snapshot of generation g+1: everything in it is already in the
+ * snapshot, so it is skipped. Same generation = replay it.
+ *
+ * TORN WRITES:
+ * Every record carries a checksum. A crash in the middle of an append
+ * leaves a broken last record; replay stops there and cuts it off.
+ * Nothing after it was acknowledged (answers go out after the flush).
+ * A journal shorter than its header is a reset that was cut short (step
+ * 3): its records are all in the snapshot, so it starts over.
+ *
+ * DAMAGE IS NOT A TORN WRITE: a snapshot or a journal header that is
+ * there but isn't ours (magic, version) makes startup refuse and leaves
+ * the files as they are. Starting empty would throw away every patient.
+ *
+ * FAILED FLUSHES: a write can fail halfway (disk full). What did go out
+ * stays in the file and is remembered, so the retry appends only the rest
+ * and the journal ends up as if the first write had worked. A failed
+ * fdatasync is not retried: Linux reports it once and may already have
+ * dropped the pages, so a second call could succeed without the data on
+ * disk. From then on every flush fails, and only a snapshot (which holds
+ * the whole clinic, pending commands included) makes the store good again.
+ * A snapshot whose journal reset (step 3) fails is already in, with the
+ * new generation, so the journal on disk is the old one or headerless.
+ * Appending to it would lose those commands on restart (old generation,
+ * skipped) or make the restart refuse. So the next flush resets it first
+ * and fails, writing nothing, until that works.
+ *
+ * FORMATS (little endian, whatever the CPU writes - not portable between
+ * machines, it is a restart file, not an exchange format):
+ *
+ *   snapshot: header { "TRIAGESN", version, generation, patients,
+ *                      next arrival, payload bytes, checksum }
+ *             patients: { severity, arrival, name length, name, '\0' }
+ *   journal:  header { "TRIAGEJN", version, generation }
+ *             records: { op, name length, value, checksum, name, '\0' }
+ *
+ * Names are stored with their '\0', so replay hands pointers straight
+ * into the mapped file to triage_* - no copies.
+ * ===================================================================== */
+
+#include "triage_store.h"
+#include <chrono>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define STORE_VERSION 1
+#define SNAPSHOT_MAGIC "TRIAGESN"
+#define JOURNAL_MAGIC "TRIAGEJN"
+
+enum { OP_ADMIT = 1, OP_BUMP = 2, OP_DISCHARGE = 3 };
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t generation;
+    uint64_t patients;
+    int64_t next_arrival;
+    uint64_t payload_bytes;
+    uint64_t checksum;
+} snapshot_header_t;
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t generation;
+} journal_header_t;
+
+typedef struct {
+    uint8_t op;
+    uint8_t reserved;
+    uint16_t name_len;
+    int32_t value;
+    uint32_t checksum;  // over op, name_len, value and the name
+} journal_record_t;
+
+struct triage_store {
+    std::string snapshot_path;
+    std::string journal_path;
+    std::string dir;
+    int journal_fd;
+    uint32_t generation;
+    long long journal_length;  // records since the snapshot
+    int sync_writes;
+    std::string pending;       // records not written yet
+    size_t pending_written;    // ... except this many bytes, a flush failed halfway
+    bool sync_failed;          // fdatasync failed: journal writes can't be trusted until a snapshot
+    bool reset_pending;        // a snapshot is in, but its journal reset failed
+};
+
+// 8 bytes per step, so checking a big snapshot doesn't dominate the restart
+static uint64_t checksum64(const void* data, size_t len, uint64_t h = 0x243F6A8885A308D3ULL) {
+    const unsigned char* p = (const unsigned char*)data;
+    while (len >= 8) {
+        uint64_t w;
+        memcpy(&w, p, 8);
+        h = (h ^ w) * 0x9E3779B97F4A7C15ULL;
+        h ^= h >> 32;
+        p += 8;
+        len -= 8;
+    }
+    while (len--) {
+        h = (h ^ *p++) * 0x100000001B3ULL;
+    }
+    return h ^ (h >> 29);
+}
+
+static uint32_t record_checksum(const journal_record_t* r, const char* name) {
+    uint64_t h = checksum64(&r->op, 1);
+    h = checksum64(&r->name_len, 2, h);
+    h = checksum64(&r->value, 4, h);
+    return (uint32_t)checksum64(name, r->name_len, h);
+}
+
+// *written (if given) = how much went out, also when it fails halfway
+static bool write_all(int fd, const char* data, size_t len, size_t* written = NULL) {
+    size_t done = 0;
+    bool ok = true;
+    while (done < len) {
+        ssize_t n = write(fd, data + done, len - done);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) { ok = false; break; }
+        done += (size_t)n;
+    }
+    if (written) *written = done;
+    return ok;
+}
+
+// Maps a whole file read-only. Returns NULL for a missing or empty file
+static const char* map_file(const std::string& path, size_t* size) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return NULL;
+    struct stat st;
+    const char* data = NULL;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        void* m = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (m != MAP_FAILED) {
+            data = (const char*)m;
+            *size = (size_t)st.st_size;
+            madvise(m, *size, MADV_SEQUENTIAL);
+        }
+    }
+    close(fd);
+    return data;
+}
+
+/* =====================================================================
+ * Loading
+ * ===================================================================== */
+
+// 1 = loaded, 0 = no snapshot yet, -1 = broken
+static int load_snapshot(triage_store_t* s, triage_t* t, long long* patients) {
+    size_t size = 0;
+    const char* data = map_file(s->snapshot_path, &size);
+    if (!data)
+        return access(s->snapshot_path.c_str(), F_OK) == 0 ? -1 : 0;
+
+    snapshot_header_t h;
+    int result = -1;
+    if (size >= sizeof(h)) {
+        memcpy(&h, data, sizeof(h));
+        const char* p = data + sizeof(h);
+        const char* end = p + h.payload_bytes;
+        if (memcmp(h.magic, SNAPSHOT_MAGIC, 8) == 0 && h.version == STORE_VERSION &&
+            h.payload_bytes == size - sizeof(h) && checksum64(p, h.payload_bytes) == h.checksum) {
+            result = 1;
+            hash_map_reserve(t->dict, (unsigned)h.patients);  // one table, no resizes
+            for (uint64_t i = 0; i < h.patients; i++) {
+                int32_t severity, arrival;
+                uint32_t len;
+                if (end - p < 12) { result = -1; break; }
+                memcpy(&severity, p, 4);
+                memcpy(&arrival, p + 4, 4);
+                memcpy(&len, p + 8, 4);
+                p += 12;
+                if ((size_t)(end - p) < len + 1 || p[len] != '\0') { result = -1; break; }
+                triage_admit_at(t, p, severity, arrival);
+                p += len + 1;
+            }
+            t->arrival = (int)h.next_arrival;
+            s->generation = h.generation;
+            *patients = (long long)h.patients;
+        }
+    }
+    munmap((void*)data, size);
+    return result;
+}
+
+static journal_header_t journal_header(uint32_t generation) {
+    journal_header_t h = {};
+    memcpy(h.magic, JOURNAL_MAGIC, 8);
+    h.version = STORE_VERSION;
+    h.generation = generation;
+    return h;
+}
+
+enum { JOURNAL_REPLAYED = 1, JOURNAL_NONE = 0, JOURNAL_DAMAGED = -1, JOURNAL_NEWER = -2 };
+
+// Replays the journal if it belongs to the snapshot and cuts off a torn tail.
+// JOURNAL_NONE = nothing to replay (missing, reset cut short, older
+// generation): start a new one. JOURNAL_NEWER = its snapshot is lost
+static int replay_journal(triage_store_t* s, triage_t* t) {
+    size_t size = 0;
+    const char* data = map_file(s->journal_path, &size);
+    if (!data) {
+        struct stat st;  // missing or empty is fine, there but unreadable is not
+        return stat(s->journal_path.c_str(), &st) == 0 && st.st_size > 0 ? JOURNAL_DAMAGED : JOURNAL_NONE;
+    }
+
+    journal_header_t h;
+    int result = JOURNAL_NONE;
+    if (size < sizeof(h)) {
+        // the start of the header reset_journal writes for this snapshot, or not ours
+        journal_header_t fresh = journal_header(s->generation);
+        if (memcmp(data, &fresh, size) != 0)
+            result = JOURNAL_DAMAGED;
+    } else {
+        memcpy(&h, data, sizeof(h));
+        if (memcmp(h.magic, JOURNAL_MAGIC, 8) != 0 || h.version != STORE_VERSION) {
+            result = JOURNAL_DAMAGED;
+        } else if (h.generation > s->generation) {
+            result = JOURNAL_NEWER;
+        } else if (h.generation == s->generation) {
+            result = JOURNAL_REPLAYED;
+            size_t pos = sizeof(h);
+            while (pos + sizeof(journal_record_t) <= size) {
+                journal_record_t r;
+                memcpy(&r, data + pos, sizeof(r));
+                const char* name = data + pos + sizeof(r);
+                if (pos + sizeof(r) + r.name_len + 1 > size || name[r.name_len] != '\0' ||
+                    record_checksum(&r, name) != r.checksum)
+                    break;  // torn / garbage tail
+                if (r.op == OP_ADMIT) triage_admit(t, name, r.value);
+                else if (r.op == OP_BUMP) triage_bump(t, name, r.value);
+                else if (r.op == OP_DISCHARGE) triage_discharge(t, name);
+                pos += sizeof(r) + r.name_len + 1;
+                s->journal_length++;
+            }
+            if (pos < size && truncate(s->journal_path.c_str(), (off_t)pos) != 0)
+                result = JOURNAL_DAMAGED;
+        }
+    }
+    munmap((void*)data, size);
+    return result;
+}
+
+// Empties the journal and stamps it with the current generation.
+// Until that worked, reset_pending keeps flushes off the journal
+static bool reset_journal(triage_store_t* s) {
+    journal_header_t h = journal_header(s->generation);
+    s->reset_pending = true;
+    if (ftruncate(s->journal_fd, 0) != 0 || !write_all(s->journal_fd, (const char*)&h, sizeof(h)) ||
+        fdatasync(s->journal_fd) != 0)
+        return false;
+    s->reset_pending = false;
+    s->sync_failed = false;
+    return true;
+}
+
+triage_store_t* triage_store_open(const char* dir, triage_t* t, int sync_writes) {
+    auto start = std::chrono::steady_clock::now();
+    mkdir(dir, 0755);
+
+    triage_store_t* s = new triage_store_t;
+    s->dir = dir;
+    s->snapshot_path = s->dir + "/snapshot.bin";
+    s->journal_path = s->dir + "/journal.bin";
+    s->journal_fd = -1;
+    s->generation = 0;
+    s->journal_length = 0;
+    s->sync_writes = sync_writes;
+    s->pending_written = 0;
+    s->sync_failed = false;
+    s->reset_pending = false;
+
+    long long patients = 0;
+    if (load_snapshot(s, t, &patients) < 0) {
+        fprintf(stderr, "triage_store: %s is damaged\n", s->snapshot_path.c_str());
+        delete s;
+        return NULL;
+    }
+    int journal = replay_journal(s, t);
+    if (journal == JOURNAL_DAMAGED || journal == JOURNAL_NEWER) {
+        fprintf(stderr, "triage_store: %s %s\n", s->journal_path.c_str(),
+                journal == JOURNAL_NEWER ? "doesn't match the snapshot" : "is damaged");
+        delete s;
+        return NULL;
+    }
+
+    s->journal_fd = open(s->journal_path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (s->journal_fd < 0 || (journal == JOURNAL_NONE && !reset_journal(s))) {
+        perror("triage_store: journal");
+        triage_store_close(s);
+        return NULL;
+    }
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    fprintf(stderr, "triage_store: %lld patients from the snapshot + %lld journal commands in %.1f ms\n",
+            patients, s->journal_length, ms);
+    return s;
+}
+
+/* =====================================================================
+ * Journal appends - buffered, written by triage_store_flush
+ * ===================================================================== */
+static void log_command(triage_store_t* s, int op, const char* name, int value) {
+    size_t len = strlen(name);
+    if (len > UINT16_MAX)
+        len = UINT16_MAX;  // the server never gets lines this long
+    journal_record_t r = {};
+    r.op = (uint8_t)op;
+    r.name_len = (uint16_t)len;
+    r.value = value;
+    r.checksum = record_checksum(&r, name);
+    s->pending.append((const char*)&r, sizeof(r));
+    s->pending.append(name, len);
+    s->pending.push_back('\0');
+    s->journal_length++;
+}
+
+void triage_store_log_admit(triage_store_t* s, const char* name, int severity) {
+    log_command(s, OP_ADMIT, name, severity);
+}
+
+void triage_store_log_bump(triage_store_t* s, const char* name, int increase) {
+    log_command(s, OP_BUMP, name, increase);
+}
+
+void triage_store_log_discharge(triage_store_t* s, const char* name) {
+    log_command(s, OP_DISCHARGE, name, 0);
+}
+
+int triage_store_flush(triage_store_t* s) {
+    if (s->pending.empty())
+        return 0;
+    if (s->reset_pending && !reset_journal(s))
+        return -1;
+    if (s->sync_failed)
+        return -1;
+    size_t written = 0;
+    bool ok = write_all(s->journal_fd, s->pending.data() + s->pending_written,
+                        s->pending.size() - s->pending_written, &written);
+    s->pending_written += written;
+    if (!ok)
+        return -1;
+    s->pending.clear();
+    s->pending_written = 0;
+    if (s->sync_writes && fdatasync(s->journal_fd) != 0) {
+        s->sync_failed = true;
+        return -1;
+    }
+    return 0;
+}
+
+long long triage_store_journal_length(triage_store_t* s) {
+    return s->journal_length;
+}
+
+/* =====================================================================
+ * Snapshots
+ * ===================================================================== */
+static void append_patient(const char* name, void* value, void* ctx) {
+    std::string* out = (std::string*)ctx;
+    Patient* p = (Patient*)value;
+    int32_t severity = p->severity, arrival = p->arrival;
+    uint32_t len = (uint32_t)strlen(name);
+    out->append((const char*)&severity, 4);
+    out->append((const char*)&arrival, 4);
+    out->append((const char*)&len, 4);
+    out->append(name, len + 1);
+}
+
+// Doesn't need the pending records written: t has them, and if anything
+// fails they are still pending
+int triage_store_snapshot(triage_store_t* s, triage_t* t) {
+    std::string payload;
+    payload.reserve(t->dict->length * 32);
+    hash_map_foreach(t->dict, append_patient, &payload);
+
+    snapshot_header_t h = {};
+    memcpy(h.magic, SNAPSHOT_MAGIC, 8);
+    h.version = STORE_VERSION;
+    h.generation = s->generation + 1;
+    h.patients = t->dict->length;
+    h.next_arrival = t->arrival;
+    h.payload_bytes = payload.size();
+    h.checksum = checksum64(payload.data(), payload.size());
+
+    std::string tmp = s->snapshot_path + ".tmp";
+    int fd = open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    bool ok = fd >= 0 && write_all(fd, (const char*)&h, sizeof(h)) &&
+              write_all(fd, payload.data(), payload.size()) && fsync(fd) == 0;
+    if (fd >= 0)
+        close(fd);
+    if (!ok || rename(tmp.c_str(), s->snapshot_path.c_str()) != 0) {
+        unlink(tmp.c_str());
+        return -1;
+    }
+
+    // make the rename itself durable before the journal forgets anything
+    int dir_fd = open(s->dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dir_fd >= 0) {
+        fsync(dir_fd);
+        close(dir_fd);
+    }
+
+    // the snapshot has everything up to here, pending records included
+    s->generation = h.generation;
+    s->journal_length = 0;
+    s->pending.clear();
+    s->pending_written = 0;
+    return reset_journal(s) ? 0 : -1;
+}
+
+void triage_store_close(triage_store_t* s) {
+    if (!s)
+        return;
+    triage_store_flush(s);
+    if (s->journal_fd >= 0)
+        close(s->journal_fd);
+    delete s;
+}
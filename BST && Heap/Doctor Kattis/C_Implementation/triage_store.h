@@ -0,0 +1,33 @@
+#ifndef C_IMPLEMENTATION_TRIAGE_STORE_H
+#define C_IMPLEMENTATION_TRIAGE_STORE_H
+
+#include "triage.h"
+
+// Snapshot + journal for a triage_t, kept in one directory (see triage_store.cpp)
+typedef struct triage_store triage_store_t;
+
+// Loads DIR/snapshot.bin and replays DIR/journal.bin into t (which must be
+// empty), then keeps the journal open for appending. NULL on error, also
+// when either file is damaged (they are left as they are).
+triage_store_t* triage_store_open(const char* dir, triage_t* t, int sync_writes);
+
+// Record a command BEFORE acknowledging it (they are buffered)
+void triage_store_log_admit(triage_store_t* s, const char* name, int severity);
+void triage_store_log_bump(triage_store_t* s, const char* name, int increase);
+void triage_store_log_discharge(triage_store_t* s, const char* name);
+
+// Writes the buffered records to the journal (+ fdatasync if sync_writes). 0 on success.
+// After a failed write, calling it again appends only what didn't go out.
+// After a failed fdatasync it keeps failing until the next snapshot
+int triage_store_flush(triage_store_t* s);
+
+// Commands in the journal since the last snapshot
+long long triage_store_journal_length(triage_store_t* s);
+
+// Writes a new snapshot of t (pending records included) and starts an empty journal. 0 on success.
+// If only the journal reset failed, the next flush retries it and fails until it works
+int triage_store_snapshot(triage_store_t* s, triage_t* t);
+
+void triage_store_close(triage_store_t* s);
+
+#endif
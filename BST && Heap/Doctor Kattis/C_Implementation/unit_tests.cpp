@@ -0,0 +1,45 @@
+#include "hash_map_test.h"
+#include "position_test.h"
+#include "rbtree_pool_test.h"
+#ifdef __linux__
+#include "store_test.h"
+#endif
+
+#include <iostream>
+#include <string>
+
+// ./unit_tests - the randomized tests of this directory, seeded so a
+// failure replays the same way. Exits 1 if any of them fails
+int main() {
+    int failed = 0;
+    auto report = [&](const std::string& result) {
+        std::cout << result << "\n";
+        failed += result.compare(0, 4, "FAIL") == 0;
+    };
+
+    report(run_rbtree_pool_generated_test(1000, 123));
+    report(run_rbtree_pool_generated_test(20000, 123));
+    report(run_rbtree_pool_generated_test(20000, 987654321u));
+    report(run_rbtree_pool_generated_test(20000, 123, true));
+
+    for (bool swiss : {false, true}) {
+        report(run_hash_map_generated_test(1000, 123, swiss));
+        report(run_hash_map_generated_test(20000, 123, swiss));
+        report(run_hash_map_generated_test(20000, 987654321u, swiss));
+    }
+
+    for (triage_mode_t mode : {TRIAGE_BUCKETS, TRIAGE_RBTREE, TRIAGE_PAIRING, TRIAGE_RBTREE_POOL}) {
+        report(run_position_generated_test(mode, 0, 20000, 123));
+        report(run_position_generated_test(mode, 3, 5000, 123));
+    }
+    report(run_position_generated_test(TRIAGE_BUCKETS, 0, 20000, 123, true));
+    report(run_position_generated_test(TRIAGE_BUCKETS, 3, 5000, 123, true));
+
+#ifdef __linux__ // triage_store is only built on Linux (see CMakeLists.txt)
+    report(run_store_recovery_test(123));
+    report(run_store_recovery_test(987654321u));
+#endif
+
+    std::cout << (failed ? "FAILED: " + std::to_string(failed) : std::string("ALL PASSED")) << "\n";
+    return failed ? 1 : 0;
+}
@@ -1,86 +1,366 @@
 //Problem link: https://codeforces.com/problemset/problem/20/C
+//Usage: ./Dijkstra [--queue auto|binary|dary|radix|dial] [--bidirectional] [--alt FILE [--landmarks K]] [--ch FILE] [--threads T] [--batch T]
+//                  [--graph FILE [--verify]] < input
+//  --queue          auto = dial for small weights, radix otherwise (dial itself too above 2^24)
+//  --bidirectional  search from both ends at once (bidirectional_dijkstra.h), ignores --queue
+//  --alt FILE       A* with landmark lower bounds (alt.h). Loads the landmark tables from FILE,
+//                   or builds K of them (default 16) and saves them there for the next run
+//  --ch FILE        contraction hierarchy query (contraction_hierarchy.h). Loads the hierarchy from FILE,
+//                   or contracts the graph (slow, once) and saves it there for the next run
+//  --threads T      delta-stepping on T threads, 0 = every core (delta_stepping.h). Builds the whole
+//                   shortest path tree in parallel instead of stopping at node n, ignores --queue
+//  --batch T        query server: after the edges, read "s t" pairs until the end of the input and answer
+//                   every one (one line each, in input order) on T threads, 0 = every core. The graph is
+//                   parsed once; queries use --ch or --alt if given, bidirectional Dijkstra otherwise
+//  --graph FILE     map the graph from a binary file made by ./csr_convert (csr_file.h) instead of reading
+//                   the edges from the input - no parsing. The plain search runs right on the mapped arrays;
+//                   the other modes copy them first (and need 4-byte weights). With --batch, the input is
+//                   just the queries; without it stdin isn't read at all. --verify also checks the whole file
+//                   against its checksum
 
 #include <iostream>
 #include <vector>
-#include <queue>
 #include <algorithm>
+#include <climits>
+#include <cstring>
+#include <charconv>
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include "../FastIO/fast_io.h"
+#include "csr_graph.h"
+#include "csr_file.h"
+#include "dijkstra.h"
+#include "bidirectional_dijkstra.h"
+#include "alt.h"
+#include "contraction_hierarchy.h"
+#include "delta_stepping.h"
+#include "dary_heap.h"
+#include "radix_heap.h"
+#include "dial_queue.h"
 using namespace std;
 
 using ll = long long;
 const ll INF = LLONG_MAX / 4; //A large value representing infinity divide by 4 to avoid overflow when adding weights
+const int DIAL_MAX_WEIGHT = 1 << 12; //auto picks Dial's buckets up to this weight, the bucket array stays small
+const ll DIAL_MAX_BUCKETS = 1 << 24; //--queue dial takes radix above this weight, one bucket per unit would be gigabytes
 
-int main() {
-    ios::sync_with_stdio(false);
-    cin.tie(nullptr); //SPEED!!!
-
-    int nodeCount, edgeCount;
-    cin >> nodeCount >> edgeCount;
+static void printPath(FastWriter& out, const vector<int>& path) {
+    // Please invent teleportation technology if there is no path
+    if (path.empty()) {
+        out.write("-1\n");
+        return;
+    }
+    for (int node : path) {
+        out.writeInt(node);
+        out.put(' ');
+    }
+    out.put('\n');
+}
 
-    vector<vector<pair<int, ll>>> graph(nodeCount + 1);
+// The tables only fit the graph they were built for - the fingerprint checks that
+static dsa::Landmarks loadLandmarks(const dsa::CsrGraph<int>& graph, const char* file, int count) {
+    uint64_t fingerprint = dsa::csr_fingerprint(graph);
+    dsa::Landmarks landmarks;
+    if (!landmarks.load(file, fingerprint)) {
+        landmarks = dsa::build_landmarks(graph, graph, count);
+        if (!landmarks.save(file, fingerprint))
+            cerr << "can't write " << file << "\n";
+    }
+    return landmarks;
+}
 
-    for (int i = 0; i < edgeCount; i++) {
-        int from, to;
-        ll weight;
-        cin >> from >> to >> weight;
+static dsa::ContractionHierarchy loadHierarchy(const dsa::CsrGraph<int>& graph, const char* file) {
+    uint64_t fingerprint = dsa::csr_fingerprint(graph);
+    dsa::ContractionHierarchy ch;
+    if (!ch.load(file, fingerprint)) {
+        ch = dsa::build_contraction_hierarchy(graph);
+        if (!ch.save(file, fingerprint))
+            cerr << "can't write " << file << "\n";
+    }
+    return ch;
+}
 
-        //for this problem we have an undirected graph, for directed graphs just add one direction instead of both and check only outgoing edges
-        graph[from].push_back({to, weight});
-        graph[to].push_back({from, weight});
+// Using the previousNode array we rebuild the path from the last node to the first one
+static vector<int> pathTo(int target, const vector<ll>& minDistance, const vector<int>& previousNode) {
+    vector<int> path;
+    if (minDistance[target] != INF) {
+        for (int node = target; node != -1; node = previousNode[node]) {
+            path.push_back(node);
+        }
+        reverse(path.begin(), path.end());
     }
+    return path;
+}
 
+// We always go to the next node with the smallest distance - which queue finds it is up to --queue
+// We only need node n, so the search stops as soon as node n is settled
+// Graph is the CsrGraph read from the input, or a CsrView right into a --graph file
+template <class Graph>
+static vector<int> shortestPath(const Graph& graph, int nodeCount, const char* queue, ll maxWeight) {
     vector<ll> minDistance(nodeCount + 1, INF);
     vector<int> previousNode(nodeCount + 1, -1);
 
-    // From point A to point A of course that the distance is 0
-    minDistance[1] = 0;
+    if (strcmp(queue, "binary") == 0) {
+        dsa::BinaryHeapQueue pq;
+        dsa::dijkstra(graph, 1, pq, minDistance, previousNode, nodeCount);
+    } else if (strcmp(queue, "dary") == 0) {
+        dsa::IndexedDaryHeap<ll, 4> pq(nodeCount + 1);
+        dsa::dijkstra(graph, 1, pq, minDistance, previousNode, nodeCount);
+    } else if (strcmp(queue, "dial") == 0) {
+        dsa::DialQueue<int> pq(maxWeight);
+        dsa::dijkstra(graph, 1, pq, minDistance, previousNode, nodeCount);
+    } else {
+        dsa::RadixHeap<int> pq;
+        dsa::dijkstra(graph, 1, pq, minDistance, previousNode, nodeCount);
+    }
+    return pathTo(nodeCount, minDistance, previousNode);
+}
+
+// Same line as printPath, into a string
+static void appendPath(string& out, const vector<int>& path) {
+    if (path.empty()) {
+        out += "-1\n";
+        return;
+    }
+    char digits[16];
+    for (int node : path) {
+        out.append(digits, to_chars(digits, digits + sizeof(digits), node).ptr);
+        out += ' ';
+    }
+    out += '\n';
+}
+
+/* Batch mode: the queries are cut into chunks of CHUNK. Every worker thread
+ * has its OWN search engine (makeEngine() once per thread - its arrays are
+ * reused for every query it answers, never shared) and takes the next chunk,
+ * formatting the answers into that chunk's string. The main thread writes
+ * the chunks out in order as soon as each one is done. Workers stay at most
+ * WINDOW chunks ahead of the writer, so a slow chunk can't make all the
+ * other answers pile up in memory. */
+template <class MakeEngine>
+static void answerBatch(FastWriter& out, const vector<pair<int, int>>& queries, int nodeCount,
+                        unsigned threads, MakeEngine makeEngine) {
+    const size_t CHUNK = 256, WINDOW = 64;
+    const size_t chunks = (queries.size() + CHUNK - 1) / CHUNK;
+    if (threads == 0)
+        threads = max(1u, thread::hardware_concurrency());
 
-    // We always go to the next node with the smallest distance
-    priority_queue<
-        pair<ll,int>,
-        vector<pair<ll,int>>,
-        greater<pair<ll,int>>
-    > pq;
+    vector<string> answers(chunks);
+    vector<char> done(chunks, 0);
+    size_t nextChunk = 0, written = 0;
+    mutex lock;
+    condition_variable changed;
+
+    auto worker = [&]() {
+        auto engine = makeEngine();
+        while (true) {
+            size_t c;
+            {
+                unique_lock<mutex> guard(lock);
+                changed.wait(guard, [&] { return nextChunk >= chunks || nextChunk < written + WINDOW; });
+                if (nextChunk >= chunks)
+                    return;
+                c = nextChunk++;
+            }
+            string text;
+            for (size_t q = c * CHUNK; q < min(queries.size(), (c + 1) * CHUNK); q++) {
+                auto [source, target] = queries[q];
+                if (source < 1 || source > nodeCount || target < 1 || target > nodeCount)
+                    text += "-1\n"; // not a node of this graph
+                else
+                    appendPath(text, engine.query(source, target).path);
+            }
+            {
+                lock_guard<mutex> guard(lock);
+                answers[c] = move(text);
+                done[c] = 1;
+            }
+            changed.notify_all();
+        }
+    };
 
-    pq.push({0, 1});
+    vector<thread> pool;
+    for (unsigned t = 0; t < threads; t++)
+        pool.emplace_back(worker);
+    for (size_t c = 0; c < chunks; c++) {
+        string text;
+        {
+            unique_lock<mutex> guard(lock);
+            changed.wait(guard, [&] { return done[c] != 0; });
+            text = move(answers[c]);
+            written = c + 1;
+        }
+        changed.notify_all();
+        out.write(text);
+    }
+    for (thread& t : pool)
+        t.join();
+}
 
-    while (!pq.empty()) {
-        auto [currentDist, currentNode] = pq.top();
-        pq.pop();
+int main(int argc, char** argv) {
+    const char* queue = "auto";
+    bool bidirectional = false;
+    const char* altFile = NULL;
+    const char* chFile = NULL;
+    int landmarkCount = 16;
+    int threads = -1;
+    int batchThreads = -1;
+    const char* graphFile = NULL;
+    bool verify = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--queue") == 0 && i + 1 < argc) queue = argv[++i];
+        else if (strcmp(argv[i], "--bidirectional") == 0) bidirectional = true;
+        else if (strcmp(argv[i], "--alt") == 0 && i + 1 < argc) altFile = argv[++i];
+        else if (strcmp(argv[i], "--ch") == 0 && i + 1 < argc) chFile = argv[++i];
+        else if (strcmp(argv[i], "--landmarks") == 0 && i + 1 < argc) landmarkCount = max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) threads = max(0, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--batch") == 0 && i + 1 < argc) batchThreads = max(0, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--graph") == 0 && i + 1 < argc) graphFile = argv[++i];
+        else if (strcmp(argv[i], "--verify") == 0) verify = true;
+    }
 
-        // We can have outdated entries in the priority queue so we ignore them, we store in the minDistance array the best known distance to each node
-        if (currentDist > minDistance[currentNode]) continue;
+    // stdin only when it has something for us: the edges, or the --batch queries. With --graph
+    // alone it may be a terminal, and reading it all would wait for an EOF that never comes
+    optional<FastReader> in; //SPEED!!!
+    if (!graphFile || batchThreads >= 0)
+        in.emplace();
+    FastWriter out;
 
-        for (auto &edge : graph[currentNode]) { // Explore all neighbors
-            int neighbor = edge.first;
-            ll edgeWeight = edge.second;
+    int nodeCount;
+    ll maxWeight = 0;
+    dsa::CsrGraph<int> graph;
+    dsa::CsrGraph<ll> wideGraph; // the input had a weight above INT_MAX
+    bool wide = false;
+    dsa::CsrFile file;
 
-            ll newDistance = minDistance[currentNode] + edgeWeight; // The distance to one of the neighbors might be shorter if we go through the shortest path that passes through the current node
+    if (graphFile) {
+        if (!file.open(graphFile, verify)) {
+            cerr << "can't load " << graphFile << " (missing, not made by csr_convert, or damaged)\n";
+            return 1;
+        }
+        nodeCount = (int)file.n() - 1; // node 0 is unused, as below
+        maxWeight = file.max_weight();
+    } else {
+        nodeCount = in->readInt();
+        int edgeCount = in->readInt();
 
-            if (newDistance < minDistance[neighbor]) {
-                minDistance[neighbor] = newDistance;
-                previousNode[neighbor] = currentNode; //Using the previousNode array to rebuild the path later
-                pq.push({newDistance, neighbor});
+        // Read the edges first, then build the whole adjacency in one go (see csr_graph.h)
+        // 4-byte weights keep an edge at 8 bytes. The first weight above INT_MAX widens the
+        // list once and the rest is read as 8, like csr_convert does
+        dsa::EdgeList<int> edges;
+        dsa::EdgeList<ll> wideEdges;
+        edges.reserve(edgeCount);
+        for (int i = 0; i < edgeCount; i++) {
+            ll from = in->readInt(), to = in->readInt();
+            ll weight = in->readInt();
+            if (from < 1 || from > nodeCount || to < 1 || to > nodeCount || weight < 0) {
+                cerr << "edge " << i + 1 << " (" << from << " " << to << " " << weight << ") is not valid\n";
+                return 1;
             }
+            if (!wide && weight > INT_MAX) {
+                wideEdges.from = move(edges.from);
+                wideEdges.to = move(edges.to);
+                wideEdges.weight.assign(edges.weight.begin(), edges.weight.end());
+                wideEdges.reserve(edgeCount);
+                edges = dsa::EdgeList<int>();
+                wide = true;
+            }
+            if (wide)
+                wideEdges.add((uint32_t)from, (uint32_t)to, weight);
+            else
+                edges.add((uint32_t)from, (uint32_t)to, (int)weight);
+            maxWeight = max(maxWeight, weight);
         }
+
+        //for this problem we have an undirected graph, for directed graphs pass false and only the given direction is stored
+        if (wide)
+            wideGraph = dsa::build_csr(nodeCount + 1, wideEdges, true);
+        else
+            graph = dsa::build_csr(nodeCount + 1, edges, true);
     }
 
-    // Please invent teleportation technology if there is no path
-    if (minDistance[nodeCount] == INF) {
-        cout << "-1\n";
+    if (strcmp(queue, "auto") == 0)
+        queue = maxWeight <= DIAL_MAX_WEIGHT ? "dial" : "radix";
+    if (strcmp(queue, "dial") == 0 && maxWeight > DIAL_MAX_BUCKETS) {
+        cerr << "weights up to " << maxWeight << " are too large for dial's buckets, using radix\n";
+        queue = "radix";
+    }
+
+    if (graphFile) {
+        // Plain search: straight on the mapped arrays, nothing parsed or copied
+        if (!bidirectional && !altFile && !chFile && threads < 0 && batchThreads < 0) {
+            if (file.weight_bytes() == 4)
+                printPath(out, shortestPath(file.view<int>(), nodeCount, queue, maxWeight));
+            else
+                printPath(out, shortestPath(file.view<ll>(), nodeCount, queue, maxWeight));
+            return 0;
+        }
+        // The other searches are written for a CsrGraph<int>: copy the arrays over (no parsing still)
+        if (file.weight_bytes() != 4) {
+            cerr << graphFile << " has 8-byte weights, only the plain search takes those\n";
+            return 1;
+        }
+        graph = file.copy<int>();
+    } else if (wide) {
+        if (bidirectional || altFile || chFile || threads >= 0 || batchThreads >= 0) {
+            cerr << "weights above " << INT_MAX << " in the input, only the plain search takes those\n";
+            return 1;
+        }
+        printPath(out, shortestPath(wideGraph, nodeCount, queue, maxWeight));
+        return 0;
+    }
+
+    if (batchThreads >= 0) {
+        vector<pair<int, int>> queries;
+        while (in->hasMore()) {
+            int source = in->readInt(), target = in->readInt();
+            queries.push_back({source, target});
+        }
+        if (chFile) {
+            dsa::ContractionHierarchy ch = loadHierarchy(graph, chFile);
+            answerBatch(out, queries, nodeCount, batchThreads, [&] { return dsa::ChSearch(ch); });
+        } else if (altFile) {
+            dsa::Landmarks landmarks = loadLandmarks(graph, altFile, landmarkCount);
+            answerBatch(out, queries, nodeCount, batchThreads, [&] { return dsa::AltSearch<int>(graph, landmarks); });
+        } else {
+            answerBatch(out, queries, nodeCount, batchThreads, [&] { return dsa::BidirectionalSearch<int>(graph, graph); });
+        }
         return 0;
     }
 
-    // Using the previousNode array we rebuild the path from the last node to the first one
     vector<int> path;
-    for (int node = nodeCount; node != -1; node = previousNode[node]) {
-        path.push_back(node);
+    if (bidirectional) {
+        path = dsa::bidirectional_dijkstra(graph, graph, 1, nodeCount).path; // undirected: backward graph = graph
+        printPath(out, path);
+        return 0;
     }
-    reverse(path.begin(), path.end());
 
-    for (int node : path) {
-        cout << node << " ";
+    if (altFile) {
+        dsa::Landmarks landmarks = loadLandmarks(graph, altFile, landmarkCount);
+        dsa::AltSearch<int> search(graph, landmarks);
+        printPath(out, search.query(1, nodeCount).path);
+        return 0;
     }
-    cout << "\n";
+
+    if (chFile) {
+        dsa::ContractionHierarchy ch = loadHierarchy(graph, chFile);
+        dsa::ChSearch search(ch);
+        printPath(out, search.query(1, nodeCount).path);
+        return 0;
+    }
+
+    if (threads >= 0) {
+        vector<ll> minDistance(nodeCount + 1, INF);
+        vector<int> previousNode(nodeCount + 1, -1);
+        dsa::delta_stepping(graph, 1, minDistance, previousNode, 0, threads);
+        printPath(out, pathTo(nodeCount, minDistance, previousNode));
+        return 0;
+    }
+
+    printPath(out, shortestPath(graph, nodeCount, queue, maxWeight));
 
     return 0;
 }
\ No newline at end of file
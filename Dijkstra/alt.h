@@ -0,0 +1,419 @@
+#ifndef DIJKSTRA_ALT_H
+#define DIJKSTRA_ALT_H
+
+/* =====================================================================
+ * ALT = A* + LANDMARKS + TRIANGLE INEQUALITY
+ * =====================================================================
+ * Dijkstra from s explores in every direction equally, most of that work
+ * is AWAY from t. A* fixes that with a potential pi(v) = a lower bound
+ * on dist(v, t): the queue key becomes dist(s, v) + pi(v), so vertices
+ * that are "on the way" come out first and the search runs towards t.
+ *
+ * WHERE THE LOWER BOUND COMES FROM:
+ * Preprocessing picks k LANDMARKS and stores the exact distance from
+ * every vertex to every landmark. For a landmark L, the triangle
+ * inequality gives
+ *
+ *   dist(L, t) <= dist(L, v) + dist(v, t)   =>  dist(v, t) >= dist(L, t) - dist(L, v)
+ *   dist(v, L) <= dist(v, t) + dist(t, L)   =>  dist(v, t) >= dist(v, L) - dist(t, L)
+ *
+ * and pi(v) = the best of these over all landmarks (and 0). A landmark
+ * "behind" t, seen from v, gives a tight bound. Each bound is a
+ * CONSISTENT potential (reduced weights w(u,v) - pi(u) + pi(v) >= 0)
+ * and so is their max, which makes A* plain Dijkstra on reduced
+ * weights: keys are monotone (the radix heap works), and the search can
+ * stop the moment t is settled.
+ *
+ * A bound can also prove v can't reach t at all (L reaches v but not t,
+ * or t reaches L but v doesn't) - then v is never queued.
+ *
+ * CHOOSING LANDMARKS - good ones sit at the edge of the map:
+ *   farthest  first landmark = the vertex farthest from a random start,
+ *             every next one = the vertex farthest from all picked so far
+ *   avoid     (Goldberg & Harrelson) grow a shortest path tree from a
+ *             random root, weight every vertex by how BAD the current
+ *             bound to it is (dist - lower bound), skip subtrees that
+ *             already contain a landmark, and walk down to a leaf through
+ *             the heaviest subtrees: a new landmark where the current
+ *             ones help least
+ *
+ * STORAGE: vertex major, uint32 per distance -
+ *   from[v * k + i] = dist(L_i, v)
+ * so the k distances a query needs for v are one or two cache lines.
+ * Undirected graphs need one table (dist(v, L) = dist(L, v)), directed
+ * ones a second table "to" computed on the reverse graph.
+ * k = 16 on a million vertices = 64 MB per table.
+ * A distance of 2^32 or more doesn't need big weights - a long chain of
+ * 10^6 weights gets there. The first one turns the tables WIDE: from64 /
+ * to64, uint64 per distance, twice the memory, same bounds. Graphs whose
+ * distances fit keep the small tables.
+ * ===================================================================== */
+
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "csr_graph.h"
+#include "dijkstra.h"
+#include "radix_heap.h"
+
+namespace dsa {
+
+enum class LandmarkMethod { Farthest, Avoid };
+
+class Landmarks {
+public:
+    static constexpr uint32_t UNREACHED = UINT32_MAX;
+
+    uint32_t n = 0;
+    uint32_t k = 0;
+    bool symmetric = true;           // undirected: no "to" table
+    bool wide = false;               // from64 / to64 instead of from / to
+    std::vector<uint32_t> ids;       // the landmark vertices
+    std::vector<uint32_t> from;      // from[v * k + i] = dist(L_i, v)
+    std::vector<uint32_t> to;        // to[v * k + i] = dist(v, L_i), empty if symmetric
+    std::vector<uint64_t> from64;    // the same when a distance needs more than 32 bits
+    std::vector<uint64_t> to64;      // (unreached = UINT64_MAX there)
+
+    // Lower bound on dist(v, t); LLONG_MAX = v provably can't reach t
+    long long lower_bound(uint32_t v, uint32_t t) const {
+        return wide ? bound(from64, to64, v, t) : bound(from, to, v, t);
+    }
+
+    // 32 bit tables -> 64 bit ones, UNREACHED stays unreached
+    void widen() {
+        if (wide)
+            return;
+        auto copy = [](std::vector<uint32_t>& narrow, std::vector<uint64_t>& wide_table) {
+            wide_table.resize(narrow.size());
+            for (size_t i = 0; i < narrow.size(); i++)
+                wide_table[i] = narrow[i] == UNREACHED ? UINT64_MAX : narrow[i];
+            std::vector<uint32_t>().swap(narrow);
+        };
+        copy(from, from64);
+        copy(to, to64);
+        wide = true;
+    }
+
+    bool save(const std::string& path, uint64_t graph_fingerprint) const;
+    bool load(const std::string& path, uint64_t graph_fingerprint);
+
+private:
+    template <class D>
+    long long bound(const std::vector<D>& from_table, const std::vector<D>& to_table, uint32_t v, uint32_t t) const {
+        const D unreached = std::numeric_limits<D>::max();
+        const D* fv = &from_table[(size_t)v * k];
+        const D* ft = &from_table[(size_t)t * k];
+        const D* tv = symmetric ? fv : &to_table[(size_t)v * k];
+        const D* tt = symmetric ? ft : &to_table[(size_t)t * k];
+        long long best = 0;
+        for (uint32_t i = 0; i < k; i++) {
+            if (fv[i] != unreached) {
+                if (ft[i] == unreached) return LLONG_MAX;  // L reaches v but not t
+                best = std::max(best, (long long)ft[i] - (long long)fv[i]);
+            }
+            if (tt[i] != unreached) {
+                if (tv[i] == unreached) return LLONG_MAX;  // t reaches L but v doesn't
+                best = std::max(best, (long long)tv[i] - (long long)tt[i]);
+            }
+        }
+        return best;
+    }
+};
+
+namespace alt_detail {
+
+// Full single source Dijkstra (radix heap)
+template <class W>
+void distances(const CsrGraph<W>& g, uint32_t source, std::vector<long long>& dist, std::vector<int>& prev) {
+    dist.assign(g.n, LLONG_MAX / 4);
+    prev.assign(g.n, -1);
+    RadixHeap<int> pq;
+    dijkstra(g, (int)source, pq, dist, prev);
+}
+
+// The column of one landmark. Widens lm's tables first if a distance doesn't fit in 32 bits
+inline void store_column(Landmarks& lm, bool to_table, uint32_t column, const std::vector<long long>& dist) {
+    for (size_t v = 0; v < dist.size() && !lm.wide; v++)
+        if (dist[v] < LLONG_MAX / 4 && dist[v] >= (long long)Landmarks::UNREACHED)
+            lm.widen();
+    auto store = [&](auto& table) {
+        typedef typename std::remove_reference_t<decltype(table)>::value_type D;
+        for (size_t v = 0; v < dist.size(); v++)
+            table[v * lm.k + column] = dist[v] >= LLONG_MAX / 4 ? std::numeric_limits<D>::max() : (D)dist[v];
+    };
+    if (lm.wide)
+        store(to_table ? lm.to64 : lm.from64);
+    else
+        store(to_table ? lm.to : lm.from);
+}
+
+// Vertex where the avoid heuristic puts the next landmark, or -1 if the
+// tree from this root has no room left (every subtree holds a landmark)
+template <class W>
+int avoid_pick(const CsrGraph<W>& g, const Landmarks& lm, uint32_t root, const std::vector<uint8_t>& is_landmark) {
+    std::vector<long long> dist;
+    std::vector<int> prev;
+    distances(g, root, dist, prev);
+
+    // Children lists of the shortest path tree, in CSR form again
+    std::vector<uint32_t> first(g.n + 1, 0), child(g.n);
+    for (uint32_t v = 0; v < g.n; v++)
+        if (prev[v] >= 0) first[prev[v] + 1]++;
+    for (uint32_t v = 0; v < g.n; v++)
+        first[v + 1] += first[v];
+    std::vector<uint32_t> fill(first.begin(), first.end() - 1);
+    std::vector<uint32_t> order;  // tree vertices, parents before children
+    order.reserve(g.n);
+    for (uint32_t v = 0; v < g.n; v++)
+        if (prev[v] >= 0) child[fill[prev[v]]++] = v;
+    order.push_back(root);
+    for (size_t i = 0; i < order.size(); i++)
+        for (uint32_t c = first[order[i]]; c < first[order[i] + 1]; c++)
+            order.push_back(child[c]);
+
+    // size(v) = sum of (dist - bound) in v's subtree, -1 if it holds a landmark
+    // (columns of landmarks not picked yet are all UNREACHED, lower_bound skips them)
+    std::vector<long long> size(g.n, 0);
+    for (size_t i = order.size(); i-- > 0; ) {
+        uint32_t v = order[i];
+        long long s = dist[v] - lm.lower_bound(root, v);
+        bool blocked = is_landmark[v];
+        for (uint32_t c = first[v]; c < first[v + 1] && !blocked; c++) {
+            if (size[child[c]] < 0) blocked = true;
+            else s += size[child[c]];
+        }
+        size[v] = blocked ? -1 : s;
+    }
+
+    // Walk down through the heaviest subtree to a leaf
+    uint32_t v = root;
+    while (true) {
+        long long best = 0;
+        int next = -1;
+        for (uint32_t c = first[v]; c < first[v + 1]; c++)
+            if (size[child[c]] > best) {
+                best = size[child[c]];
+                next = (int)child[c];
+            }
+        if (next < 0)
+            return is_landmark[v] ? -1 : (int)v;
+        v = (uint32_t)next;
+    }
+}
+
+} // namespace alt_detail
+
+/* =====================================================================
+ * build_landmarks: k landmarks + their distance tables
+ * =====================================================================
+ * backward = the reverse graph (pass the same graph when undirected,
+ * then only one table is built). k full Dijkstras (2k if directed),
+ * plus one more per landmark for the avoid heuristic's trees.
+ * ===================================================================== */
+template <class W>
+Landmarks build_landmarks(const CsrGraph<W>& forward, const CsrGraph<W>& backward, uint32_t k,
+                          LandmarkMethod method = LandmarkMethod::Avoid, unsigned seed = 1) {
+    Landmarks lm;
+    lm.n = forward.n;
+    lm.k = std::min(k, forward.n);
+    lm.symmetric = &forward == &backward;
+    lm.from.assign((size_t)lm.n * lm.k, Landmarks::UNREACHED);
+    if (!lm.symmetric)
+        lm.to.assign((size_t)lm.n * lm.k, Landmarks::UNREACHED);
+
+    std::mt19937_64 rng(seed);
+    std::vector<long long> dist;
+    std::vector<int> prev;
+    std::vector<long long> closest;          // farthest: distance to the nearest landmark so far
+    std::vector<uint8_t> is_landmark(lm.n, 0);
+
+    // farthest starts from a random vertex as if it were landmark "-1"
+    if (method == LandmarkMethod::Farthest && lm.k > 0)
+        alt_detail::distances(forward, (uint32_t)(rng() % lm.n), closest, prev);
+
+    for (uint32_t i = 0; i < lm.k; i++) {
+        int pick = -1;
+        if (method == LandmarkMethod::Avoid) {
+            for (int attempt = 0; attempt < 8 && pick < 0; attempt++)
+                pick = alt_detail::avoid_pick(forward, lm, (uint32_t)(rng() % lm.n), is_landmark);
+        } else {
+            // vertices in other components (distance "infinity") win first, they have no landmark at all
+            for (uint32_t v = 0; v < lm.n; v++)
+                if (!is_landmark[v] && (pick < 0 || closest[v] > closest[pick])) pick = (int)v;
+        }
+        while (pick < 0 || is_landmark[pick])  // nothing better found: any vertex that isn't one yet
+            pick = (int)(rng() % lm.n);
+
+        lm.ids.push_back((uint32_t)pick);
+        is_landmark[pick] = 1;
+        alt_detail::distances(forward, (uint32_t)pick, dist, prev);
+        alt_detail::store_column(lm, false, i, dist);
+        if (method == LandmarkMethod::Farthest)
+            for (uint32_t v = 0; v < lm.n; v++) closest[v] = std::min(closest[v], dist[v]);
+        if (!lm.symmetric) {
+            alt_detail::distances(backward, pick, dist, prev);
+            alt_detail::store_column(lm, true, i, dist);
+        }
+    }
+    return lm;
+}
+
+/* =====================================================================
+ * AltSearch: answers many queries on one graph
+ * =====================================================================
+ * Keeps its arrays between queries and only resets the entries a query
+ * touched, so a short query costs what it explores, not O(n).
+ * ===================================================================== */
+template <class W>
+class AltSearch {
+public:
+    AltSearch(const CsrGraph<W>& graph, const Landmarks& landmarks)
+        : g_(graph), lm_(landmarks), dist_(graph.n, INF), pi_(graph.n, -1), prev_(graph.n, -1) {}
+
+    PointToPointResult query(int source, int target) {
+        PointToPointResult result;
+        RadixHeap<int> pq;
+        touch(source);
+        if (potential(source, target) != LLONG_MAX) {
+            dist_[source] = 0;
+            pq.push(pi_[source], source);
+        }
+
+        while (!pq.empty()) {
+            auto [key, u] = pq.pop();
+            if ((long long)key > dist_[u] + pi_[u]) continue;  // outdated entry
+            result.settled++;
+            if (u == target) break;
+
+            for (uint32_t e = g_.begin(u); e < g_.end(u); e++) {
+                int v = g_.targets[e];
+                long long nd = dist_[u] + g_.weights[e];
+                touch(v);
+                if (nd < dist_[v] && potential(v, target) != LLONG_MAX) {
+                    dist_[v] = nd;
+                    prev_[v] = u;
+                    pq.push(nd + pi_[v], v);
+                }
+            }
+        }
+
+        if (dist_[target] < INF) {
+            result.distance = dist_[target];
+            for (int v = target; v != -1; v = prev_[v])
+                result.path.push_back(v);
+            std::reverse(result.path.begin(), result.path.end());
+        }
+        for (int v : touched_) {
+            dist_[v] = INF;
+            pi_[v] = -1;
+            prev_[v] = -1;
+        }
+        touched_.clear();
+        return result;
+    }
+
+private:
+    static constexpr long long INF = LLONG_MAX / 4;
+
+    const CsrGraph<W>& g_;
+    const Landmarks& lm_;
+    std::vector<long long> dist_;
+    std::vector<long long> pi_;   // -1 = not computed yet for this query
+    std::vector<int> prev_;
+    std::vector<int> touched_;
+
+    void touch(int v) {
+        if (pi_[v] == -1 && dist_[v] == INF)
+            touched_.push_back(v);
+    }
+
+    long long potential(int v, int target) {
+        if (pi_[v] == -1)
+            pi_[v] = lm_.lower_bound((uint32_t)v, (uint32_t)target);
+        return pi_[v];
+    }
+};
+
+/* =====================================================================
+ * Landmark files:
+ *   "DSAALT01", n, k, symmetric, graph fingerprint,
+ *   ids[k], from[n * k], to[n * k] (if not symmetric)
+ * Wide tables: "DSAALT64" and the same with 8 bytes per distance
+ * The fingerprint is csr_fingerprint() of the forward graph, so tables
+ * built for another graph (or an older version of it) are refused.
+ * ===================================================================== */
+namespace alt_detail {
+
+template <class T>
+bool write_array(FILE* f, const std::vector<T>& a) {
+    return a.empty() || fwrite(a.data(), sizeof(T), a.size(), f) == a.size();
+}
+
+template <class T>
+bool read_array(FILE* f, std::vector<T>& a) {
+    return a.empty() || fread(a.data(), sizeof(T), a.size(), f) == a.size();
+}
+
+} // namespace alt_detail
+
+inline bool Landmarks::save(const std::string& path, uint64_t graph_fingerprint) const {
+    std::string tmp = path + ".tmp";
+    FILE* f = fopen(tmp.c_str(), "wb");
+    if (!f)
+        return false;
+    uint32_t sym = symmetric;
+    bool ok = fwrite(wide ? "DSAALT64" : "DSAALT01", 1, 8, f) == 8 &&
+              fwrite(&n, sizeof(n), 1, f) == 1 && fwrite(&k, sizeof(k), 1, f) == 1 &&
+              fwrite(&sym, sizeof(sym), 1, f) == 1 &&
+              fwrite(&graph_fingerprint, sizeof(graph_fingerprint), 1, f) == 1 &&
+              alt_detail::write_array(f, ids) &&
+              (wide ? alt_detail::write_array(f, from64) && alt_detail::write_array(f, to64)
+                    : alt_detail::write_array(f, from) && alt_detail::write_array(f, to));
+    ok = fclose(f) == 0 && ok;
+    if (!ok || rename(tmp.c_str(), path.c_str()) != 0) {
+        remove(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+inline bool Landmarks::load(const std::string& path, uint64_t graph_fingerprint) {
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f)
+        return false;
+    char magic[8];
+    uint32_t file_n, file_k, sym;
+    uint64_t fingerprint;
+    bool ok = fread(magic, 1, 8, f) == 8 &&
+              (memcmp(magic, "DSAALT01", 8) == 0 || memcmp(magic, "DSAALT64", 8) == 0) &&
+              fread(&file_n, sizeof(file_n), 1, f) == 1 && fread(&file_k, sizeof(file_k), 1, f) == 1 &&
+              fread(&sym, sizeof(sym), 1, f) == 1 &&
+              fread(&fingerprint, sizeof(fingerprint), 1, f) == 1 && fingerprint == graph_fingerprint;
+    if (ok) {
+        n = file_n;
+        k = file_k;
+        symmetric = sym != 0;
+        wide = memcmp(magic, "DSAALT64", 8) == 0;
+        ids.resize(k);
+        size_t cells = (size_t)n * k, to_cells = symmetric ? 0 : cells;
+        from.assign(wide ? 0 : cells, 0);
+        to.assign(wide ? 0 : to_cells, 0);
+        from64.assign(wide ? cells : 0, 0);
+        to64.assign(wide ? to_cells : 0, 0);
+        ok = alt_detail::read_array(f, ids) &&
+             (wide ? alt_detail::read_array(f, from64) && alt_detail::read_array(f, to64)
+                   : alt_detail::read_array(f, from) && alt_detail::read_array(f, to));
+    }
+    fclose(f);
+    return ok;
+}
+
+} // namespace dsa
+
+#endif
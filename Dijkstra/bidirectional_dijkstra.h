@@ -0,0 +1,159 @@
+#ifndef DIJKSTRA_BIDIRECTIONAL_DIJKSTRA_H
+#define DIJKSTRA_BIDIRECTIONAL_DIJKSTRA_H
+
+/* =====================================================================
+ * BIDIRECTIONAL DIJKSTRA - one source, one target
+ * =====================================================================
+ * Plain Dijkstra grows a "ball" around the source until the target is
+ * inside it. Two searches, one forward from the source and one backward
+ * from the target, each only need a ball of HALF the radius to meet.
+ * On a road network a ball's area grows like radius^2, so that is
+ * roughly half the work; on graphs that fan out faster, much more.
+ *
+ *        forward ball        backward ball
+ *          ( s  ---- meet ---- t )
+ *
+ * Each step settles one vertex from whichever side has the smaller key
+ * on top of its queue (the "cheaper" frontier).
+ *
+ * MU = the best s -> t length seen so far. Whenever a vertex v gets a
+ * distance on one side and already has one on the other, the path
+ *   s ... v ... t  =  distF[v] + distB[v]
+ * exists, and mu keeps the smallest such value (and v as "meet").
+ *
+ * STOPPING RULE: stop when  topF + topB >= mu.
+ * Any path shorter than mu would need a vertex both searches reach below
+ * their current tops - so it would have to be made of vertices not yet
+ * settled on either side, and the keys say no such path can be shorter.
+ * (Careful: stopping the moment some vertex is settled on BOTH sides is
+ * the classic mistake - the shortest path does not have to go through it.)
+ *
+ * PATH: source .. meet with the forward previousNode array, then
+ * meet .. target with the backward one (there it points TOWARDS t).
+ *
+ * backward must be the graph with every arc reversed - for an undirected
+ * graph that is the same graph. Both sides use a radix heap (lazy, like
+ * plain Dijkstra: outdated entries are skipped when they come out); the
+ * stopping rule peeks at the top keys with top_key(). An outdated top is
+ * never larger than the real one, so peeking at it can only stop later.
+ *
+ * With several shortest paths it may return a different one than plain
+ * Dijkstra does, of the same length.
+ *
+ * MANY QUERIES: BidirectionalSearch keeps its arrays between queries.
+ * Every entry carries the number of the query that wrote it (a timestamp);
+ * anything older reads as "not reached". So a query costs what it
+ * touches, not O(n) to clear the arrays first.
+ * ===================================================================== */
+
+#include <algorithm>
+#include <climits>
+#include <vector>
+#include "csr_graph.h"
+#include "dijkstra.h"
+#include "radix_heap.h"
+
+namespace dsa {
+
+template <class W>
+class BidirectionalSearch {
+public:
+    BidirectionalSearch(const CsrGraph<W>& forward, const CsrGraph<W>& backward)
+        : graph_{&forward, &backward} {
+        slots_[0].resize(forward.n);
+        slots_[1].resize(forward.n);
+    }
+
+    PointToPointResult query(int source, int target) {
+        PointToPointResult result;
+        if (++now_ == 0) {  // stamps wrapped around after 2^32 queries: start over
+            for (int side = 0; side < 2; side++)
+                std::fill(slots_[side].begin(), slots_[side].end(), Slot());
+            now_ = 1;
+        }
+        heap_[0].clear();
+        heap_[1].clear();
+
+        reach(0, source, 0, -1);
+        reach(1, target, 0, -1);
+        heap_[0].push(0, source);
+        heap_[1].push(0, target);
+
+        long long mu = source == target ? 0 : INF;
+        int meet = source == target ? source : -1;
+
+        while (!heap_[0].empty() && !heap_[1].empty()) {
+            long long top[2] = {(long long)heap_[0].top_key(), (long long)heap_[1].top_key()};
+            if (top[0] + top[1] >= mu)
+                break;
+
+            int side = top[0] <= top[1] ? 0 : 1;
+            int other = 1 - side;
+            auto [d, u] = heap_[side].pop();
+            if ((long long)d > dist(side, u))
+                continue; // outdated entry
+            result.settled++;
+
+            const CsrGraph<W>& g = *graph_[side];
+            for (uint32_t e = g.begin(u); e < g.end(u); e++) {
+                int v = g.targets[e];
+                long long nd = (long long)d + g.weights[e];
+                if (nd < dist(side, v)) {
+                    reach(side, v, nd, u);
+                    heap_[side].push(nd, v);
+                }
+                if (dist(other, v) < INF && dist(side, v) + dist(other, v) < mu) {
+                    mu = dist(side, v) + dist(other, v);
+                    meet = v;
+                }
+            }
+        }
+
+        if (meet < 0)
+            return result;
+
+        result.distance = mu;
+        for (int v = meet; v != -1; v = slots_[0][v].prev)
+            result.path.push_back(v);
+        std::reverse(result.path.begin(), result.path.end());
+        for (int v = slots_[1][meet].prev; v != -1; v = slots_[1][v].prev)
+            result.path.push_back(v);
+        return result;
+    }
+
+private:
+    static constexpr long long INF = LLONG_MAX / 4;
+
+    // Valid only if stamp == now_, so a new query "clears" everything by
+    // bumping now_ - no O(n) reset, no list of touched vertices
+    struct Slot {
+        long long dist = INF;
+        int prev = -1;
+        uint32_t stamp = 0;
+    };
+
+    const CsrGraph<W>* graph_[2];
+    std::vector<Slot> slots_[2];
+    RadixHeap<int> heap_[2];
+    uint32_t now_ = 0;
+
+    long long dist(int side, int v) const {
+        const Slot& s = slots_[side][v];
+        return s.stamp == now_ ? s.dist : INF;
+    }
+
+    void reach(int side, int v, long long d, int from) {
+        slots_[side][v] = {d, from, now_};
+    }
+};
+
+// One query; for many, keep a BidirectionalSearch around instead
+template <class W>
+PointToPointResult bidirectional_dijkstra(const CsrGraph<W>& forward, const CsrGraph<W>& backward,
+                                          int source, int target) {
+    return BidirectionalSearch<W>(forward, backward).query(source, target);
+}
+
+} // namespace dsa
+
+#endif
@@ -0,0 +1,519 @@
+#ifndef DIJKSTRA_CONTRACTION_HIERARCHY_H
+#define DIJKSTRA_CONTRACTION_HIERARCHY_H
+
+/* =====================================================================
+ * CONTRACTION HIERARCHIES (CH)
+ * =====================================================================
+ * Preprocess once (seconds to minutes), then answer a shortest path
+ * query by settling a few hundred vertices instead of millions.
+ *
+ * CONTRACTING a vertex v = removing it from the graph without changing
+ * any distance between the vertices that are left. For every pair
+ *   u -> v -> x   (u, x still in the graph)
+ * check if the path through v is the ONLY shortest way from u to x. If
+ * it is, add a SHORTCUT u -> x with weight w(u,v) + w(v,x) that
+ * remembers v ("middle"). If some other path is at least as short (a
+ * WITNESS), nothing is needed.
+ *
+ * Contract all vertices one by one; the order is the vertex's RANK.
+ * Unimportant vertices (dead ends, middle of long roads) go first,
+ * important ones (highway junctions) last.
+ *
+ * THE QUERY: every shortest path can now be walked as
+ *   UP the ranks from s ... a peak ... DOWN the ranks to t
+ * (shortcuts jump over the lower vertices in between). So:
+ *   forward search from s  only uses arcs to HIGHER rank
+ *   backward search from t only uses arcs (reversed) to HIGHER rank
+ * Both climb to the top of the hierarchy quickly and meet at the peak.
+ * Best meeting point = the shortest path.
+ *
+ * THE ORDER - priority of v (smallest contracted next):
+ *   2 * edge difference = shortcuts contracting v would add - edges removed
+ *                         (keeps the graph from filling up with shortcuts)
+ *   + deleted neighbours  (spreads contraction evenly over the map)
+ *   + level               (how many contractions deep v's neighbourhood
+ *                          already is - keeps the hierarchy flat)
+ * Priorities change as neighbours disappear, so they are updated LAZILY:
+ * pop the smallest, recompute it, and if it is not the smallest anymore
+ * put it back and try the next one.
+ *
+ * WITNESS SEARCH: a small Dijkstra from u that skips v and contracted
+ * vertices. It is cut off after a few hundred settled vertices - if it
+ * gives up, we add the shortcut anyway. That is only a wasted arc, never
+ * a wrong answer.
+ *
+ * THE CORE: the last vertices are the expensive ones - every contraction
+ * joins all their neighbours, the graph gets denser and denser. Random
+ * long edges (a small world, not a road map) make that happen early. So
+ * contraction stops once the vertices left average core_degree arcs; they
+ * keep ALL their arcs to each other in both search graphs, and inside the
+ * core the query is a plain bidirectional Dijkstra. Road maps end with a
+ * core of a few dozen vertices, other graphs trade query time for a
+ * preprocessing that finishes.
+ *
+ * UNPACKING: a shortcut a -> b with middle m stands for a -> m -> b.
+ * m was contracted before a and b, so a -> m is one of m's downward arcs
+ * and m -> b one of its upward arcs - look them up and repeat until only
+ * original edges are left. That restores the full node path.
+ *
+ * Works for directed graphs (forward graph only, incoming arcs are
+ * derived from it). Undirected = every edge stored both ways as usual.
+ * Weights are stored as long long: a shortcut can be as long as a whole
+ * path.
+ * ===================================================================== */
+
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <queue>
+#include <string>
+#include <utility>
+#include <vector>
+#include "csr_graph.h"
+#include "dijkstra.h"
+#include "radix_heap.h"
+
+namespace dsa {
+
+struct ChOptions {
+    uint32_t witness_settle_limit = 500;   // give up a witness search after this many vertices
+    uint32_t simulate_settle_limit = 50;   // the same while only estimating a priority
+    double core_degree = 32;               // stop once the vertices left average this many arcs, 0 = never
+};
+
+class ContractionHierarchy {
+public:
+    uint32_t n = 0;
+    std::vector<uint32_t> rank;      // contraction order, 0 = first contracted
+    CsrGraph<long long> up;          // v -> x with rank[x] > rank[v] (any x if both are in the core)
+    CsrGraph<long long> down;        // down[v] has x for every arc x -> v with rank[x] > rank[v] (same)
+    std::vector<int32_t> up_middle;  // middle vertex of each arc, -1 = original edge
+    std::vector<int32_t> down_middle;
+
+    size_t shortcuts() const;
+
+    // Appends the vertices after a on the original path a -> ... -> b
+    void unpack(uint32_t a, uint32_t b, int32_t middle, std::vector<int>& path) const;
+
+    bool save(const std::string& path, uint64_t graph_fingerprint) const;
+    bool load(const std::string& path, uint64_t graph_fingerprint);
+};
+
+namespace ch_detail {
+
+struct Arc {
+    uint32_t node;
+    long long weight;
+    int32_t middle;
+};
+
+// The graph while it is being contracted
+class Contractor {
+public:
+    template <class W>
+    Contractor(const CsrGraph<W>& g, ChOptions opt)
+        : n_(g.n), opt_(opt), out_(g.n), in_(g.n), deleted_neighbours_(g.n, 0), level_(g.n, 0),
+          dist_(g.n, LLONG_MAX), target_(g.n, 0) {
+        for (uint32_t u = 0; u < g.n; u++)
+            for (uint32_t e = g.begin(u); e < g.end(u); e++)
+                if (g.targets[e] != u)  // a self loop is never on a shortest path
+                    add_arc(u, g.targets[e], g.weights[e], -1);
+    }
+
+    ContractionHierarchy run() {
+        ContractionHierarchy ch;
+        ch.n = n_;
+        ch.rank.assign(n_, 0);
+
+        std::priority_queue<Item, std::vector<Item>, std::greater<Item>> order;
+        for (uint32_t v = 0; v < n_; v++)
+            order.push({priority(v), v});
+
+        uint32_t next_rank = 0;
+        while (!order.empty()) {
+            if (opt_.core_degree > 0 && 2.0 * arcs_left_ > opt_.core_degree * (n_ - next_rank))
+                break;  // what is left is the core
+            auto [p, v] = order.top();
+            order.pop();
+            long long now = priority(v);
+            if (!order.empty() && now > order.top().first) {
+                order.push({now, v});  // got worse since it was queued
+                continue;
+            }
+            ch.rank[v] = next_rank++;
+            contract(v);
+        }
+        for (; !order.empty(); order.pop())
+            ch.rank[order.top().second] = next_rank++;
+
+        // Every vertex's lists were frozen when it was contracted: out = its
+        // upward arcs, in = the arcs coming down into it. A core vertex keeps
+        // all its arcs to other core vertices in both
+        build_csr_from(out_, ch.up, ch.up_middle);
+        build_csr_from(in_, ch.down, ch.down_middle);
+        return ch;
+    }
+
+private:
+    uint32_t n_;
+    ChOptions opt_;
+    std::vector<std::vector<Arc>> out_, in_;
+    std::vector<uint32_t> deleted_neighbours_;
+    std::vector<uint32_t> level_;  // 1 + highest level of a contracted neighbour
+    size_t arcs_left_ = 0;  // arcs between vertices not contracted yet
+
+    // witness search state, reset through touched_
+    typedef std::pair<long long, uint32_t> Item;
+    std::vector<long long> dist_;
+    std::vector<uint32_t> touched_;
+    std::vector<Item> heap_;
+    std::vector<uint8_t> target_;  // 1 = out-neighbour of the vertex being contracted
+
+    // Adds u -> x, or lowers it if it is already there (one arc per pair)
+    void add_arc(uint32_t u, uint32_t x, long long w, int32_t middle) {
+        for (Arc& a : out_[u])
+            if (a.node == x) {
+                if (w < a.weight) {
+                    a.weight = w;
+                    a.middle = middle;
+                    for (Arc& b : in_[x])
+                        if (b.node == u) { b.weight = w; b.middle = middle; break; }
+                }
+                return;
+            }
+        out_[u].push_back({x, w, middle});
+        in_[x].push_back({u, w, middle});
+        arcs_left_++;
+    }
+
+    static void remove_arc_to(std::vector<Arc>& list, uint32_t node) {
+        for (size_t i = 0; i < list.size(); i++)
+            if (list[i].node == node) {
+                list[i] = list.back();
+                list.pop_back();
+                return;
+            }
+    }
+
+    // Dijkstra from source in the remaining graph without skip, up to max_dist.
+    // Stops early once every vertex marked in target_ is settled
+    void witness_search(uint32_t source, uint32_t skip, long long max_dist, uint32_t targets, uint32_t limit) {
+        for (uint32_t v : touched_) dist_[v] = LLONG_MAX;
+        touched_.clear();
+        heap_.clear();
+
+        std::greater<Item> later;
+        dist_[source] = 0;
+        touched_.push_back(source);
+        heap_.push_back({0, source});
+        uint32_t settled = 0;
+
+        while (!heap_.empty() && targets > 0) {
+            std::pop_heap(heap_.begin(), heap_.end(), later);
+            auto [d, u] = heap_.back();
+            heap_.pop_back();
+            if (d > dist_[u]) continue;
+            if (d > max_dist || ++settled > limit) break;
+            targets -= target_[u];
+            for (const Arc& a : out_[u]) {
+                if (a.node == skip) continue;  // contracted vertices are not in the lists anymore
+                long long nd = d + a.weight;
+                if (nd < dist_[a.node]) {
+                    if (dist_[a.node] == LLONG_MAX) touched_.push_back(a.node);
+                    dist_[a.node] = nd;
+                    heap_.push_back({nd, a.node});
+                    std::push_heap(heap_.begin(), heap_.end(), later);
+                }
+            }
+        }
+    }
+
+    // Shortcuts contracting v needs; adds them if !simulate
+    int shortcuts_for(uint32_t v, bool simulate) {
+        int needed = 0;
+        long long max_out = 0;
+        for (const Arc& b : out_[v]) {
+            max_out = std::max(max_out, b.weight);
+            target_[b.node] = 1;
+        }
+
+        // add_arc only changes the lists of u and x, never v's own
+        for (const Arc& a : in_[v]) {
+            // u itself is settled first and counts as one of the targets if it is one
+            witness_search(a.node, v, a.weight + max_out, (uint32_t)out_[v].size(),
+                           simulate ? opt_.simulate_settle_limit : opt_.witness_settle_limit);
+            for (const Arc& b : out_[v]) {
+                if (b.node == a.node) continue;
+                long long via = a.weight + b.weight;
+                if (dist_[b.node] <= via) continue;  // a witness is at least as short
+                needed++;
+                if (!simulate)
+                    add_arc(a.node, b.node, via, (int32_t)v);
+            }
+        }
+        for (const Arc& b : out_[v])
+            target_[b.node] = 0;
+        return needed;
+    }
+
+    long long priority(uint32_t v) {
+        int shortcuts = shortcuts_for(v, true);
+        return 2 * ((long long)shortcuts - (long long)(in_[v].size() + out_[v].size())) + deleted_neighbours_[v] + level_[v];
+    }
+
+    void contract(uint32_t v) {
+        shortcuts_for(v, false);
+        arcs_left_ -= out_[v].size() + in_[v].size();
+        for (const Arc& b : out_[v]) {
+            remove_arc_to(in_[b.node], v);
+            deleted_neighbours_[b.node]++;
+            level_[b.node] = std::max(level_[b.node], level_[v] + 1);
+        }
+        for (const Arc& a : in_[v]) {
+            remove_arc_to(out_[a.node], v);
+            deleted_neighbours_[a.node]++;
+            level_[a.node] = std::max(level_[a.node], level_[v] + 1);
+        }
+        // out_[v] / in_[v] stay as they are - all their ends are higher ranks
+    }
+
+    static void build_csr_from(const std::vector<std::vector<Arc>>& lists, CsrGraph<long long>& g,
+                               std::vector<int32_t>& middle) {
+        g.n = (uint32_t)lists.size();
+        g.offsets.assign(lists.size() + 1, 0);
+        for (size_t v = 0; v < lists.size(); v++)
+            g.offsets[v + 1] = g.offsets[v] + (uint32_t)lists[v].size();
+        g.targets.clear();
+        g.weights.clear();
+        middle.clear();
+        for (const auto& list : lists)
+            for (const Arc& a : list) {
+                g.targets.push_back(a.node);
+                g.weights.push_back(a.weight);
+                middle.push_back(a.middle);
+            }
+    }
+};
+
+} // namespace ch_detail
+
+template <class W>
+ContractionHierarchy build_contraction_hierarchy(const CsrGraph<W>& graph, ChOptions opt = ChOptions()) {
+    ch_detail::Contractor c(graph, opt);
+    return c.run();
+}
+
+inline size_t ContractionHierarchy::shortcuts() const {
+    size_t count = 0;
+    for (int32_t m : up_middle) count += m >= 0;
+    for (int32_t m : down_middle) count += m >= 0;
+    return count;
+}
+
+inline void ContractionHierarchy::unpack(uint32_t a, uint32_t b, int32_t middle, std::vector<int>& path) const {
+    struct Piece { uint32_t a, b; int32_t middle; };
+    std::vector<Piece> stack = {{a, b, middle}};
+    while (!stack.empty()) {
+        Piece p = stack.back();
+        stack.pop_back();
+        if (p.middle < 0) {
+            path.push_back((int)p.b);
+            continue;
+        }
+        uint32_t m = (uint32_t)p.middle;
+        int32_t first = -1, second = -1;
+        for (uint32_t e = down.begin(m); e < down.end(m); e++)   // a -> m
+            if (down.targets[e] == p.a) { first = down_middle[e]; break; }
+        for (uint32_t e = up.begin(m); e < up.end(m); e++)       // m -> b
+            if (up.targets[e] == p.b) { second = up_middle[e]; break; }
+        stack.push_back({m, p.b, second});  // done second
+        stack.push_back({p.a, m, first});
+    }
+}
+
+/* =====================================================================
+ * ChSearch: the query, reusable for many (s, t) pairs
+ * =====================================================================
+ * Two upward Dijkstras, the smaller top key goes next. A side stops once
+ * its top key reaches mu (the best meeting so far): everything it could
+ * still find is longer. Unlike plain bidirectional Dijkstra a side can't
+ * stop at the first meeting - the peak of the real path may be higher.
+ * ===================================================================== */
+class ChSearch {
+public:
+    explicit ChSearch(const ContractionHierarchy& ch)
+        : ch_(ch) {
+        for (int side = 0; side < 2; side++) {
+            dist_[side].assign(ch.n, INF);
+            prev_[side].assign(ch.n, -1);
+            arc_[side].assign(ch.n, 0);
+        }
+    }
+
+    PointToPointResult query(int source, int target) {
+        PointToPointResult result;
+        const CsrGraph<long long>* graph[2] = {&ch_.up, &ch_.down};
+        RadixHeap<int>* heap = heap_;
+        heap[0].clear();
+        heap[1].clear();
+        long long mu = INF;
+        int meet = -1;
+
+        reach(0, source, 0, -1, 0);
+        reach(1, target, 0, -1, 0);
+        heap[0].push(0, source);
+        heap[1].push(0, target);
+
+        while (true) {
+            bool go[2];
+            long long top[2];
+            for (int side = 0; side < 2; side++) {
+                go[side] = !heap[side].empty() && (top[side] = (long long)heap[side].top_key()) < mu;
+            }
+            if (!go[0] && !go[1])
+                break;
+            int side = go[0] && (!go[1] || top[0] <= top[1]) ? 0 : 1;
+
+            auto [d, u] = heap[side].pop();
+            if ((long long)d > dist_[side][u]) continue;  // outdated entry
+            result.settled++;
+            if (dist_[1 - side][u] < INF && (long long)d + dist_[1 - side][u] < mu) {
+                mu = (long long)d + dist_[1 - side][u];
+                meet = u;
+            }
+
+            // Stall on demand: a higher vertex already reached reaches u cheaper
+            // (down from it), so d is not u's real distance - don't search on from u
+            const CsrGraph<long long>& other = *graph[1 - side];
+            bool stalled = false;
+            for (uint32_t e = other.begin(u); e < other.end(u) && !stalled; e++)
+                stalled = dist_[side][other.targets[e]] + other.weights[e] < (long long)d;
+            if (stalled) continue;
+
+            const CsrGraph<long long>& g = *graph[side];
+            for (uint32_t e = g.begin(u); e < g.end(u); e++) {
+                int v = (int)g.targets[e];
+                long long nd = (long long)d + g.weights[e];
+                if (nd < dist_[side][v]) {
+                    reach(side, v, nd, u, e);
+                    heap[side].push(nd, v);
+                }
+            }
+        }
+
+        if (meet >= 0) {
+            result.distance = mu;
+            // s -> meet: walk the forward tree back, then unpack every arc in order
+            std::vector<int> ups;
+            for (int v = meet; v != source; v = prev_[0][v])
+                ups.push_back(v);
+            result.path.push_back(source);
+            for (size_t i = ups.size(); i-- > 0; ) {
+                int v = ups[i];
+                ch_.unpack((uint32_t)prev_[0][v], (uint32_t)v, ch_.up_middle[arc_[0][v]], result.path);
+            }
+            // meet -> t: the backward tree already points towards t
+            for (int v = meet; v != target; v = prev_[1][v])
+                ch_.unpack((uint32_t)v, (uint32_t)prev_[1][v], ch_.down_middle[arc_[1][v]], result.path);
+        }
+
+        for (int side = 0; side < 2; side++) {
+            for (int v : touched_[side]) {
+                dist_[side][v] = INF;
+                prev_[side][v] = -1;
+            }
+            touched_[side].clear();
+        }
+        return result;
+    }
+
+private:
+    static constexpr long long INF = LLONG_MAX / 4;
+
+    const ContractionHierarchy& ch_;
+    std::vector<long long> dist_[2];
+    std::vector<int> prev_[2];
+    std::vector<uint32_t> arc_[2];  // arc used to reach the vertex (for its middle)
+    std::vector<int> touched_[2];
+    RadixHeap<int> heap_[2];
+
+    void reach(int side, int v, long long d, int from, uint32_t arc) {
+        if (dist_[side][v] == INF)
+            touched_[side].push_back(v);
+        dist_[side][v] = d;
+        prev_[side][v] = from;
+        arc_[side][v] = arc;
+    }
+};
+
+/* =====================================================================
+ * Hierarchy files:
+ *   "DSACH001", n, graph fingerprint, rank[n],
+ *   up: offsets, arc count, targets, weights, middles; down: the same
+ * ===================================================================== */
+namespace ch_detail {
+
+template <class T>
+bool write_vector(FILE* f, const std::vector<T>& v) {
+    uint64_t size = v.size();
+    return fwrite(&size, sizeof(size), 1, f) == 1 &&
+           (v.empty() || fwrite(v.data(), sizeof(T), v.size(), f) == v.size());
+}
+
+template <class T>
+bool read_vector(FILE* f, std::vector<T>& v) {
+    uint64_t size;
+    if (fread(&size, sizeof(size), 1, f) != 1 || size > (1ULL << 40) / sizeof(T))
+        return false;
+    v.resize(size);
+    return v.empty() || fread(v.data(), sizeof(T), v.size(), f) == v.size();
+}
+
+} // namespace ch_detail
+
+inline bool ContractionHierarchy::save(const std::string& path, uint64_t graph_fingerprint) const {
+    std::string tmp = path + ".tmp";
+    FILE* f = fopen(tmp.c_str(), "wb");
+    if (!f)
+        return false;
+    using namespace ch_detail;
+    bool ok = fwrite("DSACH001", 1, 8, f) == 8 && fwrite(&n, sizeof(n), 1, f) == 1 &&
+              fwrite(&graph_fingerprint, sizeof(graph_fingerprint), 1, f) == 1 &&
+              write_vector(f, rank) &&
+              write_vector(f, up.offsets) && write_vector(f, up.targets) &&
+              write_vector(f, up.weights) && write_vector(f, up_middle) &&
+              write_vector(f, down.offsets) && write_vector(f, down.targets) &&
+              write_vector(f, down.weights) && write_vector(f, down_middle);
+    ok = fclose(f) == 0 && ok;
+    if (!ok || rename(tmp.c_str(), path.c_str()) != 0) {
+        remove(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+inline bool ContractionHierarchy::load(const std::string& path, uint64_t graph_fingerprint) {
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f)
+        return false;
+    using namespace ch_detail;
+    char magic[8];
+    uint64_t fingerprint;
+    bool ok = fread(magic, 1, 8, f) == 8 && memcmp(magic, "DSACH001", 8) == 0 &&
+              fread(&n, sizeof(n), 1, f) == 1 &&
+              fread(&fingerprint, sizeof(fingerprint), 1, f) == 1 && fingerprint == graph_fingerprint &&
+              read_vector(f, rank) &&
+              read_vector(f, up.offsets) && read_vector(f, up.targets) &&
+              read_vector(f, up.weights) && read_vector(f, up_middle) &&
+              read_vector(f, down.offsets) && read_vector(f, down.targets) &&
+              read_vector(f, down.weights) && read_vector(f, down_middle);
+    fclose(f);
+    up.n = down.n = n;
+    return ok && rank.size() == n && up.offsets.size() == (size_t)n + 1 && down.offsets.size() == (size_t)n + 1;
+}
+
+} // namespace dsa
+
+#endif
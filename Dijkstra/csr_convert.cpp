@@ -0,0 +1,90 @@
+//Usage: ./csr_convert OUT [--directed] [--wide] < input
+//  Turns the text input of Dijkstra.cpp ("n m", then m lines "from to weight", nodes 1..n) into a
+//  binary graph file (csr_file.h) that ./Dijkstra --graph OUT maps instead of parsing the text.
+//  Node 0 stays unused, as in Dijkstra.cpp, so node numbers are the same in both.
+//  --directed  store every edge only in its given direction (default: both ways, like Dijkstra.cpp)
+//  --wide      8-byte weights even if every weight fits in 4 (they are widened automatically otherwise)
+
+#include <iostream>
+#include <climits>
+#include <cstring>
+#include <utility>
+#include "../FastIO/fast_io.h"
+#include "csr_graph.h"
+#include "csr_file.h"
+using namespace std;
+
+using ll = long long;
+
+template <class W>
+static int writeGraph(const char* file, int nodeCount, const dsa::EdgeList<W>& edges, bool undirected) {
+    dsa::CsrGraph<W> graph = dsa::build_csr(nodeCount + 1, edges, undirected);
+    if (!dsa::save_csr_file(file, graph, undirected)) {
+        cerr << "can't write " << file << "\n";
+        return 1;
+    }
+    cout << file << ": " << nodeCount << " nodes, " << graph.arcs() << " arcs, "
+         << sizeof(W) << "-byte weights\n";
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    const char* file = NULL;
+    bool undirected = true, wide = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--directed") == 0) undirected = false;
+        else if (strcmp(argv[i], "--wide") == 0) wide = true;
+        else file = argv[i];
+    }
+    if (!file) {
+        cerr << "usage: " << argv[0] << " OUT [--directed] [--wide] < input\n";
+        return 1;
+    }
+
+    FastReader in;
+    ll nodeCount = in.readInt(), edgeCount = in.readInt();
+    if (nodeCount < 1 || nodeCount >= INT_MAX || edgeCount < 0) {
+        cerr << "bad header: " << nodeCount << " nodes, " << edgeCount << " edges\n";
+        return 1;
+    }
+
+    // 4-byte weights until one doesn't fit, then the list is widened once and the rest read as 8
+    dsa::EdgeList<int> narrow;
+    dsa::EdgeList<ll> wideEdges;
+    auto widen = [&]() {
+        wideEdges.from = move(narrow.from);
+        wideEdges.to = move(narrow.to);
+        wideEdges.weight.assign(narrow.weight.begin(), narrow.weight.end());
+        wideEdges.reserve(edgeCount);
+        narrow = dsa::EdgeList<int>();
+        wide = true;
+    };
+    if (wide)
+        widen();
+    else
+        narrow.reserve(edgeCount);
+
+    for (ll i = 0; i < edgeCount; i++) {
+        if (!in.hasMore()) {
+            cerr << "the input ends after " << i << " of " << edgeCount << " edges\n";
+            return 1;
+        }
+        ll from = in.readInt(), to = in.readInt();
+        ll weight = in.readInt();
+        // The file is trusted when it is mapped, so nothing out of range goes in
+        if (from < 1 || from > nodeCount || to < 1 || to > nodeCount || weight < 0) {
+            cerr << "edge " << i + 1 << " (" << from << " " << to << " " << weight << ") is not valid\n";
+            return 1;
+        }
+        if (!wide && weight > INT_MAX)
+            widen();
+        if (wide)
+            wideEdges.add((uint32_t)from, (uint32_t)to, weight);
+        else
+            narrow.add((uint32_t)from, (uint32_t)to, (int)weight);
+    }
+
+    if (wide)
+        return writeGraph(file, (int)nodeCount, wideEdges, undirected);
+    return writeGraph(file, (int)nodeCount, narrow, undirected);
+}
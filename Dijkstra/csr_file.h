@@ -0,0 +1,261 @@
+#ifndef DIJKSTRA_CSR_FILE_H
+#define DIJKSTRA_CSR_FILE_H
+
+/* =====================================================================
+ * BINARY CSR FILES - parse the text once, mmap the graph every run after
+ * =====================================================================
+ * Reading a graph from text costs every run the same: turn ~30 bytes of
+ * digits into each edge, then build_csr() sorts them by source. For 10^8
+ * edges that is many seconds before the first vertex is settled - the
+ * search itself is often faster than that.
+ *
+ * But the CSR arrays are already the finished product, so write them to
+ * a file exactly as they lie in memory:
+ *
+ *   header   128 bytes (below)
+ *   offsets  uint32[n + 1]
+ *   targets  uint32[arcs]
+ *   weights  int32 or int64 [arcs]   (the header says which)
+ *
+ * and the next run just mmap()s the file: the arrays ARE the mapped pages,
+ * CsrView points straight into them. No parsing, no copy, no allocation.
+ * Opening costs the same for 10 edges or 10^9 - a few system calls - and
+ * the OS reads a page from disk (or maps it from the page cache) the first
+ * time the search touches it. Vertices the search never reaches are never
+ * read at all, and several processes with the same file share one copy.
+ *
+ * Every array starts at a multiple of 64 bytes (a cache line): the mapping
+ * starts on a page, so every element is aligned and an array never shares
+ * its first line with the tail of the one before.
+ *
+ * 32-bit weights make an edge 8 bytes instead of 12 - a third less to
+ * read from disk - when they fit (the converter checks).
+ *
+ * CHECKS on open: magic, version, byte order, and a checksum of the header
+ * itself; then the array positions against the real file size and the two
+ * ends of offsets. That's all O(1). The arrays themselves are only checked
+ * with verify = true - their checksum means reading the whole file, which
+ * is exactly what this format is here to avoid. The data checksum is
+ * csr_fingerprint() of the graph, so files built from it (landmarks,
+ * hierarchies) can be matched without hashing the graph again.
+ *
+ * Byte order: the arrays are stored as the machine has them. A file from
+ * a big endian machine is refused (the endian field reads wrong), not
+ * converted.
+ * ===================================================================== */
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "csr_graph.h"
+
+namespace dsa {
+
+const uint32_t CSR_FILE_VERSION = 1;
+const uint32_t CSR_FILE_UNDIRECTED = 1;  // flags: every edge is stored both ways
+const uint64_t CSR_FILE_ALIGN = 64;
+
+struct CsrFileHeader {
+    char magic[8];             // "DSACSR\0\0"
+    uint32_t version;          // CSR_FILE_VERSION
+    uint32_t endian;           // 0x01020304 as written by the machine that made the file
+    uint32_t weight_bytes;     // 4 or 8
+    uint32_t flags;
+    uint64_t n;                // vertices
+    uint64_t arcs;
+    uint64_t offsets_at;       // byte positions of the arrays, multiples of CSR_FILE_ALIGN
+    uint64_t targets_at;
+    uint64_t weights_at;
+    uint64_t file_size;
+    int64_t max_weight;
+    uint64_t data_checksum;    // csr_fingerprint() of the graph
+    uint64_t reserved[4];      // zero
+    uint64_t header_checksum;  // checksum64 of everything above
+};
+static_assert(sizeof(CsrFileHeader) == 128, "the header is part of the file format");
+
+namespace csr_file_detail {
+
+inline uint64_t align_up(uint64_t x) { return (x + CSR_FILE_ALIGN - 1) / CSR_FILE_ALIGN * CSR_FILE_ALIGN; }
+
+inline uint64_t header_checksum(const CsrFileHeader& h) {
+    return checksum64(&h, offsetof(CsrFileHeader, header_checksum));
+}
+
+// Zero bytes up to position at, then the array
+inline bool write_at(FILE* f, uint64_t& pos, uint64_t at, const void* data, size_t bytes) {
+    static const char zeros[CSR_FILE_ALIGN] = {};
+    if (at < pos || fwrite(zeros, 1, at - pos, f) != at - pos)
+        return false;
+    pos = at + bytes;
+    return bytes == 0 || fwrite(data, 1, bytes, f) == bytes;
+}
+
+} // namespace csr_file_detail
+
+/* Writes g (W = int or long long, stored as 4 or 8 bytes) to path.
+ * undirected is only recorded in the flags - g must already hold both
+ * directions (build_csr(..., true)). Through path + ".tmp" and a rename,
+ * so a crash never leaves a half written graph under the real name. */
+template <class W>
+bool save_csr_file(const std::string& path, const CsrGraph<W>& g, bool undirected) {
+    static_assert(sizeof(W) == 4 || sizeof(W) == 8, "weights are stored as 4 or 8 bytes");
+    using namespace csr_file_detail;
+
+    CsrFileHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, "DSACSR\0\0", 8);
+    h.version = CSR_FILE_VERSION;
+    h.endian = 0x01020304;
+    h.weight_bytes = sizeof(W);
+    h.flags = undirected ? CSR_FILE_UNDIRECTED : 0;
+    h.n = g.n;
+    h.arcs = g.arcs();
+    h.offsets_at = align_up(sizeof(h));
+    h.targets_at = align_up(h.offsets_at + (h.n + 1) * sizeof(uint32_t));
+    h.weights_at = align_up(h.targets_at + h.arcs * sizeof(uint32_t));
+    h.file_size = h.weights_at + h.arcs * sizeof(W);
+    for (W w : g.weights)
+        h.max_weight = std::max<int64_t>(h.max_weight, w);
+    h.data_checksum = csr_fingerprint(g);
+    h.header_checksum = header_checksum(h);
+
+    std::string tmp = path + ".tmp";
+    FILE* f = fopen(tmp.c_str(), "wb");
+    if (!f)
+        return false;
+    uint64_t pos = 0;
+    bool ok = g.offsets.size() == h.n + 1 &&
+              write_at(f, pos, 0, &h, sizeof(h)) &&
+              write_at(f, pos, h.offsets_at, g.offsets.data(), g.offsets.size() * sizeof(uint32_t)) &&
+              write_at(f, pos, h.targets_at, g.targets.data(), g.targets.size() * sizeof(uint32_t)) &&
+              write_at(f, pos, h.weights_at, g.weights.data(), g.weights.size() * sizeof(W));
+    ok = fclose(f) == 0 && ok;
+    if (!ok || rename(tmp.c_str(), path.c_str()) != 0) {
+        remove(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+/* A graph file mapped read only. view<W>() points into the mapping, so
+ * it (and everything searched over it) is valid while the CsrFile lives. */
+class CsrFile {
+public:
+    CsrFile() = default;
+    ~CsrFile() { close(); }
+    CsrFile(const CsrFile&) = delete;
+    CsrFile& operator=(const CsrFile&) = delete;
+
+    // false if the file is missing, not a graph file, or damaged.
+    // verify = also check the arrays against the data checksum (reads all of them)
+    bool open(const std::string& path, bool verify = false) {
+        close();
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(CsrFileHeader)) {
+            ::close(fd);
+            return false;
+        }
+        size_ = (size_t)st.st_size;
+        void* p = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);  // the mapping keeps the file
+        if (p == MAP_FAILED)
+            return false;
+        data_ = (const char*)p;
+        memcpy(&header_, data_, sizeof(header_));
+        if (!valid() || (verify && !verify_arrays())) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close() {
+        if (data_)
+            munmap((void*)data_, size_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    const CsrFileHeader& header() const { return header_; }
+    uint32_t n() const { return (uint32_t)header_.n; }
+    uint32_t weight_bytes() const { return header_.weight_bytes; }
+    bool undirected() const { return header_.flags & CSR_FILE_UNDIRECTED; }
+    int64_t max_weight() const { return header_.max_weight; }
+    uint64_t fingerprint() const { return header_.data_checksum; }  // == csr_fingerprint(view<W>())
+
+    // W must have the file's weight size (int for 4 bytes, long long for 8)
+    template <class W>
+    CsrView<W> view() const {
+        if (!data_ || sizeof(W) != header_.weight_bytes)
+            throw std::invalid_argument("CsrFile::view: no file, or its weights have another size");
+        return {n(), (const uint32_t*)(data_ + header_.offsets_at), (const uint32_t*)(data_ + header_.targets_at),
+                (const W*)(data_ + header_.weights_at)};
+    }
+
+    // An owned copy, for code that wants a CsrGraph. Copies the arrays, still no parsing
+    template <class W>
+    CsrGraph<W> copy() const {
+        CsrView<W> v = view<W>();
+        CsrGraph<W> g;
+        g.n = v.n;
+        g.offsets.assign(v.offsets, v.offsets + v.n + 1);
+        g.targets.assign(v.targets, v.targets + v.arcs());
+        g.weights.assign(v.weights, v.weights + v.arcs());
+        return g;
+    }
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    CsrFileHeader header_{};
+
+    // O(1): everything that can be checked without reading the arrays
+    bool valid() const {
+        using namespace csr_file_detail;
+        const CsrFileHeader& h = header_;
+        if (memcmp(h.magic, "DSACSR\0\0", 8) != 0 || h.version != CSR_FILE_VERSION || h.endian != 0x01020304 ||
+            h.header_checksum != header_checksum(h))
+            return false;
+        if ((h.weight_bytes != 4 && h.weight_bytes != 8) || h.n >= UINT32_MAX || h.arcs > UINT32_MAX ||
+            h.file_size != size_ || h.offsets_at > size_ || h.targets_at > size_ || h.weights_at > size_)
+            return false;
+        // Arrays in order, aligned, inside the file
+        if (h.offsets_at % CSR_FILE_ALIGN || h.targets_at % CSR_FILE_ALIGN || h.weights_at % CSR_FILE_ALIGN ||
+            h.offsets_at < sizeof(CsrFileHeader) ||
+            h.targets_at < h.offsets_at + (h.n + 1) * sizeof(uint32_t) ||
+            h.weights_at < h.targets_at + h.arcs * sizeof(uint32_t) ||
+            h.file_size < h.weights_at + h.arcs * h.weight_bytes)
+            return false;
+        const uint32_t* offsets = (const uint32_t*)(data_ + h.offsets_at);
+        return offsets[0] == 0 && offsets[h.n] == h.arcs;
+    }
+
+    // O(file): the checksum, plus what the search relies on (sorted offsets, targets < n)
+    bool verify_arrays() const {
+        bool ok = weight_bytes() == 4 ? csr_fingerprint(view<int>()) == fingerprint()
+                                      : csr_fingerprint(view<long long>()) == fingerprint();
+        const uint32_t* offsets = (const uint32_t*)(data_ + header_.offsets_at);
+        const uint32_t* targets = (const uint32_t*)(data_ + header_.targets_at);
+        for (uint64_t v = 0; ok && v < header_.n; v++)
+            ok = offsets[v] <= offsets[v + 1];
+        for (uint64_t e = 0; ok && e < header_.arcs; e++)
+            ok = targets[e] < header_.n;
+        return ok;
+    }
+};
+
+} // namespace dsa
+
+#endif
@@ -0,0 +1,213 @@
+#ifndef DIJKSTRA_CSR_GRAPH_H
+#define DIJKSTRA_CSR_GRAPH_H
+
+/* =====================================================================
+ * CSR GRAPH (Compressed Sparse Row)
+ * =====================================================================
+ * vector<vector<pair<int, ll>>> is the textbook adjacency list, but:
+ *   - one heap allocation per vertex, lists scattered all over memory
+ *   - pair<int, ll> is 16 bytes (4 bytes of padding per edge)
+ *   - push_back growth copies every list a few times while reading
+ *
+ * CSR puts ALL edges in one array, sorted by their source vertex:
+ *
+ *   offsets: [0, 2, 3, 6, ...]          n + 1 entries
+ *   targets: [4, 7 | 1 | 0, 2, 9 | ...]  edges of vertex 0 | 1 | 2 | ...
+ *   weights: [5, 1 | 8 | 2, 2, 3 | ...]  same order as targets
+ *
+ * The edges of vertex v are [offsets[v], offsets[v + 1]). Relaxing them
+ * is a walk over two contiguous arrays, so the hardware prefetcher does
+ * the work instead of one cache miss per list. Targets and weights are
+ * separate arrays (structure of arrays): no padding, and an int weight
+ * makes an edge 8 bytes instead of 16.
+ *
+ * BUILDING (two passes over the edge list, counting sort by source):
+ *   1. count the out-degree of every vertex
+ *   2. prefix sum of the degrees = offsets
+ *   3. drop every edge into the next free slot of its source
+ *
+ * PARALLEL: the edge list is cut into one chunk per thread. Each thread
+ * counts its own chunk (pass 1), and the prefix sum hands every thread
+ * its OWN slot range inside each vertex: for vertex v, thread 0's edges
+ * come first, then thread 1's, ... So pass 2 needs no atomics, and the
+ * result is exactly what one thread would build - edges of a vertex stay
+ * in input order, same paths on ties.
+ * The price is one counter array per thread (n ints each).
+ * ===================================================================== */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace dsa {
+
+// Edges as read from the input, also structure of arrays
+template <class W>
+struct EdgeList {
+    std::vector<uint32_t> from, to;
+    std::vector<W> weight;
+
+    void reserve(size_t m) { from.reserve(m); to.reserve(m); weight.reserve(m); }
+    void add(uint32_t u, uint32_t v, W w) { from.push_back(u); to.push_back(v); weight.push_back(w); }
+    size_t size() const { return from.size(); }
+};
+
+template <class W>
+struct CsrGraph {
+    uint32_t n = 0;
+    std::vector<uint32_t> offsets;  // n + 1
+    std::vector<uint32_t> targets;
+    std::vector<W> weights;
+
+    uint32_t begin(uint32_t v) const { return offsets[v]; }
+    uint32_t end(uint32_t v) const { return offsets[v + 1]; }
+    uint32_t degree(uint32_t v) const { return offsets[v + 1] - offsets[v]; }
+    size_t arcs() const { return targets.size(); }
+};
+
+// The same graph over arrays someone else owns (a mapped file, csr_file.h):
+// nothing copied, same begin/end/targets[e]/weights[e] as CsrGraph, so
+// dijkstra() runs on either
+template <class W>
+struct CsrView {
+    uint32_t n = 0;
+    const uint32_t* offsets = nullptr;  // n + 1
+    const uint32_t* targets = nullptr;
+    const W* weights = nullptr;
+
+    uint32_t begin(uint32_t v) const { return offsets[v]; }
+    uint32_t end(uint32_t v) const { return offsets[v + 1]; }
+    uint32_t degree(uint32_t v) const { return offsets[v + 1] - offsets[v]; }
+    size_t arcs() const { return offsets ? offsets[n] : 0; }
+};
+
+template <class W>
+CsrView<W> view(const CsrGraph<W>& g) {
+    return {g.n, g.offsets.data(), g.targets.data(), g.weights.data()};
+}
+
+/* =====================================================================
+ * build_csr: edge list -> CSR over vertices 0..n-1
+ * =====================================================================
+ * undirected = every edge is stored both ways (u -> v right before v -> u,
+ * the order push_back on both lists gives).
+ * threads = 0 picks hardware_concurrency; small inputs use one thread,
+ * starting threads costs more than counting a few thousand edges.
+ * ===================================================================== */
+template <class W>
+CsrGraph<W> build_csr(uint32_t n, const EdgeList<W>& edges, bool undirected, unsigned threads = 0) {
+    const size_t m = edges.size();
+    const size_t arcs = undirected ? 2 * m : m;
+    if (arcs > UINT32_MAX)
+        throw std::length_error("build_csr: more than 2^32 - 1 arcs");
+
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    const size_t min_chunk = 1 << 16;
+    threads = (unsigned)std::min<size_t>(threads, std::max<size_t>(1, m / min_chunk));
+
+    CsrGraph<W> g;
+    g.n = n;
+    g.offsets.assign((size_t)n + 1, 0);
+    g.targets.resize(arcs);
+    g.weights.resize(arcs);
+
+    auto chunk_begin = [&](unsigned t) { return m * t / threads; };
+
+    // run(t) for every chunk, on its own thread unless there is only one
+    auto parallel = [&](auto&& run) {
+        if (threads == 1) {
+            run(0u);
+            return;
+        }
+        std::vector<std::thread> pool;
+        for (unsigned t = 0; t < threads; t++)
+            pool.emplace_back(run, t);
+        for (std::thread& th : pool)
+            th.join();
+    };
+
+    // Pass 1: per thread out-degree counts of its chunk
+    std::vector<std::vector<uint32_t>> count(threads);
+    parallel([&](unsigned t) {
+        std::vector<uint32_t>& c = count[t];
+        c.assign(n, 0);
+        for (size_t i = chunk_begin(t), e = chunk_begin(t + 1); i < e; i++) {
+            c[edges.from[i]]++;
+            if (undirected)
+                c[edges.to[i]]++;
+        }
+    });
+
+    // Prefix sum, vertex major then thread: count[t][v] becomes the first
+    // slot thread t writes for v. Sequential - O(n * threads), no edges touched
+    uint32_t next = 0;
+    for (uint32_t v = 0; v < n; v++) {
+        g.offsets[v] = next;
+        for (unsigned t = 0; t < threads; t++) {
+            uint32_t c = count[t][v];
+            count[t][v] = next;
+            next += c;
+        }
+    }
+    g.offsets[n] = next;
+
+    // Pass 2: scatter, every thread into its own slots
+    parallel([&](unsigned t) {
+        std::vector<uint32_t>& slot = count[t];
+        for (size_t i = chunk_begin(t), e = chunk_begin(t + 1); i < e; i++) {
+            uint32_t u = edges.from[i], v = edges.to[i];
+            uint32_t k = slot[u]++;
+            g.targets[k] = v;
+            g.weights[k] = edges.weight[i];
+            if (undirected) {
+                k = slot[v]++;
+                g.targets[k] = u;
+                g.weights[k] = edges.weight[i];
+            }
+        }
+    });
+    return g;
+}
+
+/* =====================================================================
+ * csr_fingerprint: 64-bit checksum of the whole graph
+ * =====================================================================
+ * Files derived from a graph (landmark tables, ...) store it, so loading
+ * them next to a DIFFERENT graph is caught instead of giving wrong
+ * answers. Mixes 8 bytes per step, about as fast as reading the arrays.
+ * ===================================================================== */
+inline uint64_t checksum64(const void* data, size_t len, uint64_t h = 0x243F6A8885A308D3ULL) {
+    const unsigned char* p = (const unsigned char*)data;
+    while (len >= 8) {
+        uint64_t w;
+        memcpy(&w, p, 8);
+        h = (h ^ w) * 0x9E3779B97F4A7C15ULL;
+        h ^= h >> 32;
+        p += 8;
+        len -= 8;
+    }
+    while (len--)
+        h = (h ^ *p++) * 0x100000001B3ULL;
+    return h ^ (h >> 29);
+}
+
+template <class W>
+uint64_t csr_fingerprint(const CsrView<W>& g) {
+    uint64_t h = checksum64(&g.n, sizeof(g.n));
+    h = checksum64(g.offsets, g.offsets ? ((size_t)g.n + 1) * sizeof(uint32_t) : 0, h);
+    h = checksum64(g.targets, g.arcs() * sizeof(uint32_t), h);
+    return checksum64(g.weights, g.arcs() * sizeof(W), h);
+}
+
+template <class W>
+uint64_t csr_fingerprint(const CsrGraph<W>& g) {
+    return csr_fingerprint(view(g));
+}
+
+} // namespace dsa
+
+#endif
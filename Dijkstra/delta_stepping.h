@@ -0,0 +1,286 @@
+#ifndef DIJKSTRA_DELTA_STEPPING_H
+#define DIJKSTRA_DELTA_STEPPING_H
+
+/* =====================================================================
+ * DELTA-STEPPING - single source shortest paths on many cores
+ * =====================================================================
+ * Dijkstra settles ONE vertex at a time: the next one depends on the
+ * last. Delta-stepping settles a whole DISTANCE RANGE at a time:
+ *
+ *   bucket i = vertices with tentative distance in [i * delta, (i+1) * delta)
+ *
+ * Take the lowest non-empty bucket and relax the edges of ALL its
+ * vertices in parallel. Some land in the same bucket again (their
+ * distance went down but stays in range) - repeat until the bucket stays
+ * empty. Then every distance below (i+1) * delta is final.
+ *   delta = 1 (integer weights) -> Dijkstra with Dial's buckets
+ *   delta = infinity            -> Bellman-Ford
+ * In between: enough vertices per step to keep every core busy, few
+ * enough re-relaxations to not waste the work.
+ *
+ * LIGHT / HEAVY edges: an edge with w <= delta ("light") can put its
+ * target into the CURRENT bucket, so light edges are relaxed again every
+ * time the bucket refills. A heavy edge (w > delta) always lands in a
+ * later bucket, so it is relaxed only ONCE, after the bucket is final.
+ * The graph is copied with every vertex's light arcs first, heavy arcs
+ * after, so each phase walks exactly the arcs it needs.
+ *
+ * PARALLEL:
+ *   - distances are updated with an atomic min (compare-exchange loop on
+ *     the caller's minDistance, std::atomic_ref)
+ *   - every thread has its OWN buckets, a bucket is gathered from all of
+ *     them into one shared frontier before it is processed
+ *   - the frontier is handed out in chunks of 256 vertices (an atomic
+ *     counter), so one vertex with a huge degree doesn't stall the rest
+ *   - the threads are started once and run the whole search together,
+ *     meeting at a std::barrier between phases (no thread per phase)
+ * Buckets are cyclic: everything pending is at most max_weight / delta + 1
+ * buckets ahead, so that many lists are enough however far the search goes.
+ *
+ * previousNode: the atomic min can't update a (distance, previous) pair
+ * together, so the tree is rebuilt after the search, one more parallel
+ * pass over the arcs: for every vertex, among the neighbours u with
+ * dist[u] + w == dist[v] and w > 0, the one with the smallest distance,
+ * then the smallest number - the tie rule of dijkstra.h, so for positive
+ * weights it is exactly Dijkstra's tree.
+ * Vertices only reachable through weight 0 edges get theirs from a short
+ * sequential pass (the rule could close a cycle there).
+ *
+ * minDistance must come in filled with "infinity", previousNode with -1
+ * (like dijkstra()). delta = 0 picks max_weight / average degree, the
+ * usual choice (raised if it would need more than ~1M bucket lists);
+ * threads = 0 uses every core. Returns how many vertices are reachable.
+ * ===================================================================== */
+
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <climits>
+#include <cstdint>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "csr_graph.h"
+
+namespace dsa {
+
+template <class W>
+size_t delta_stepping(const CsrGraph<W>& graph, int source, std::vector<long long>& minDistance,
+                      std::vector<int>& previousNode, long long delta = 0, unsigned threads = 0) {
+    const uint32_t n = graph.n;
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+
+    long long max_weight = 0;
+    bool zero_weights = false;
+    for (W w : graph.weights) {
+        max_weight = std::max(max_weight, (long long)w);
+        zero_weights = zero_weights || w == 0;
+    }
+    if (delta <= 0)
+        delta = (long long)((double)max_weight * n / (double)std::max<size_t>(1, graph.arcs()));
+    delta = std::max({delta, 1LL, max_weight >> 20});  // at most ~1M bucket lists per thread
+    const uint64_t ring = (uint64_t)(max_weight / delta) + 2;  // buckets that can be pending at once
+
+    // Light arcs first, then heavy: split[v] = first heavy arc of v
+    std::vector<uint32_t> targets(graph.arcs()), split(n);
+    std::vector<W> weights(graph.arcs());
+
+    std::vector<uint8_t> settled(n, 0);  // heavy arcs relaxed = distance final, reached
+    std::vector<uint32_t> frontier;
+    std::vector<size_t> sizes(threads), offsets(threads);
+    std::vector<uint64_t> lowest(threads);
+    std::atomic<size_t> next_chunk{0};
+    std::barrier sync((std::ptrdiff_t)threads);
+    const size_t CHUNK = 256;
+
+    auto atomic_min = [](auto& slot, auto value) {
+        std::atomic_ref<std::remove_reference_t<decltype(slot)>> a(slot);
+        auto current = a.load(std::memory_order_relaxed);
+        while (value < current)
+            if (a.compare_exchange_weak(current, value, std::memory_order_relaxed))
+                return true;
+        return false;
+    };
+    auto load = [](long long& slot) { return std::atomic_ref<long long>(slot).load(std::memory_order_relaxed); };
+
+    auto worker = [&](unsigned t) {
+        const uint32_t lo = (uint32_t)((uint64_t)n * t / threads), hi = (uint32_t)((uint64_t)n * (t + 1) / threads);
+
+        for (uint32_t v = lo; v < hi; v++) {
+            uint32_t light = graph.begin(v), heavy = graph.end(v);
+            for (uint32_t e = graph.begin(v); e < graph.end(v); e++) {
+                uint32_t k = (long long)graph.weights[e] <= delta ? light++ : --heavy;
+                targets[k] = graph.targets[e];
+                weights[k] = graph.weights[e];
+            }
+            split[v] = light;
+        }
+
+        std::vector<std::vector<uint32_t>> buckets(ring);
+        std::vector<uint32_t> done_here;  // vertices this thread took out of the current bucket
+        uint64_t cursor = 0;              // no own bucket below this one is non-empty
+
+        auto relax = [&](uint32_t u, uint32_t from, uint32_t to) {
+            long long du = load(minDistance[u]);
+            for (uint32_t e = from; e < to; e++) {
+                long long nd = du + weights[e];
+                if (atomic_min(minDistance[targets[e]], nd)) {
+                    uint64_t b = (uint64_t)(nd / delta);
+                    buckets[b % ring].push_back(targets[e]);
+                    cursor = std::min(cursor, b);
+                }
+            }
+        };
+
+        if (t == 0) {
+            minDistance[source] = 0;
+            buckets[0].push_back((uint32_t)source);
+        }
+        sync.arrive_and_wait();
+
+        uint64_t bucket = 0;
+        while (true) {
+            // Gather bucket from every thread into the frontier
+            std::vector<uint32_t>& mine = buckets[bucket % ring];
+            sizes[t] = mine.size();
+            sync.arrive_and_wait();
+            if (t == 0) {
+                size_t total = 0;
+                for (unsigned i = 0; i < threads; i++) {
+                    offsets[i] = total;
+                    total += sizes[i];
+                }
+                frontier.resize(total);
+                next_chunk.store(0, std::memory_order_relaxed);
+            }
+            sync.arrive_and_wait();
+            std::copy(mine.begin(), mine.end(), frontier.begin() + (std::ptrdiff_t)offsets[t]);
+            mine.clear();
+            sync.arrive_and_wait();
+
+            if (!frontier.empty()) {
+                // Light phase: may refill this bucket, so gather again afterwards
+                size_t start;
+                while ((start = next_chunk.fetch_add(CHUNK, std::memory_order_relaxed)) < frontier.size()) {
+                    size_t end = std::min(frontier.size(), start + CHUNK);
+                    for (size_t i = start; i < end; i++) {
+                        uint32_t u = frontier[i];
+                        if ((uint64_t)(load(minDistance[u]) / delta) != bucket)
+                            continue;  // went down to an earlier bucket since it was put here
+                        done_here.push_back(u);
+                        relax(u, graph.begin(u), split[u]);
+                    }
+                }
+                sync.arrive_and_wait();
+                continue;
+            }
+
+            // The bucket is final: heavy arcs, once per vertex
+            for (uint32_t u : done_here) {
+                std::atomic_ref<uint8_t> flag(settled[u]);
+                if (flag.exchange(1, std::memory_order_relaxed) == 0)
+                    relax(u, split[u], graph.end(u));
+            }
+            done_here.clear();
+
+            // Next bucket = the lowest non-empty one of any thread
+            uint64_t c = std::max(cursor, bucket + 1);
+            while (c < bucket + ring && buckets[c % ring].empty())
+                c++;
+            cursor = c;
+            lowest[t] = c < bucket + ring ? c : UINT64_MAX;
+            sync.arrive_and_wait();
+            bucket = *std::min_element(lowest.begin(), lowest.end());
+            if (bucket == UINT64_MAX)
+                break;
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; t++)
+        pool.emplace_back(worker, t);
+    worker(0);
+    for (std::thread& th : pool)
+        th.join();
+
+    // previousNode with the tie rule of dijkstra.h
+    auto parallel_vertices = [&](auto&& body) {
+        std::vector<std::thread> helpers;
+        auto run = [&](unsigned t) {
+            uint32_t lo = (uint32_t)((uint64_t)n * t / threads), hi = (uint32_t)((uint64_t)n * (t + 1) / threads);
+            for (uint32_t u = lo; u < hi; u++)
+                if (settled[u])
+                    body(u);
+        };
+        for (unsigned t = 1; t < threads; t++)
+            helpers.emplace_back(run, t);
+        run(0);
+        for (std::thread& th : helpers)
+            th.join();
+    };
+    auto optimal = [&](uint32_t u, uint32_t e) {
+        return graph.weights[e] > 0 && minDistance[u] + graph.weights[e] == minDistance[graph.targets[e]];
+    };
+    if (max_weight <= (long long)UINT32_MAX) {
+        // One pass over the arcs: key = (max_weight - w) << 32 | u. The smallest key
+        // has the largest weight (= the smallest neighbour distance), then the smallest u
+        std::vector<uint64_t> best(n, UINT64_MAX);
+        parallel_vertices([&](uint32_t u) {
+            for (uint32_t e = graph.begin(u); e < graph.end(u); e++)
+                if (optimal(u, e))
+                    atomic_min(best[graph.targets[e]], (uint64_t)(max_weight - (long long)graph.weights[e]) << 32 | u);
+        });
+        parallel_vertices([&](uint32_t v) {
+            if (best[v] != UINT64_MAX)
+                previousNode[v] = (int)(uint32_t)best[v];
+        });
+    } else {
+        // Weights too wide for the key: smallest neighbour distance first, then the smallest u
+        std::vector<long long> best(n, LLONG_MAX);
+        parallel_vertices([&](uint32_t u) {
+            for (uint32_t e = graph.begin(u); e < graph.end(u); e++)
+                if (optimal(u, e))
+                    atomic_min(best[graph.targets[e]], minDistance[u]);
+        });
+        std::vector<uint32_t> node(n, UINT32_MAX);
+        parallel_vertices([&](uint32_t u) {
+            for (uint32_t e = graph.begin(u); e < graph.end(u); e++)
+                if (optimal(u, e) && minDistance[u] == best[graph.targets[e]])
+                    atomic_min(node[graph.targets[e]], u);
+        });
+        parallel_vertices([&](uint32_t v) {
+            if (node[v] != UINT32_MAX)
+                previousNode[v] = (int)node[v];
+        });
+    }
+
+    size_t reached = 0;
+    for (uint32_t v = 0; v < n; v++)
+        reached += settled[v];
+
+    // Weight 0 edges: hang the vertices still without a previous one below a
+    // vertex that has one, walking 0-weight arcs from the finished part of the tree
+    if (zero_weights) {
+        std::vector<uint32_t> queue;
+        for (uint32_t v = 0; v < n; v++)
+            if (settled[v] && (previousNode[v] != -1 || (int)v == source))
+                queue.push_back(v);
+        for (size_t i = 0; i < queue.size(); i++) {
+            uint32_t u = queue[i];
+            for (uint32_t e = graph.begin(u); e < graph.end(u); e++) {
+                uint32_t v = graph.targets[e];
+                if (graph.weights[e] == 0 && previousNode[v] == -1 && (int)v != source &&
+                    minDistance[v] == minDistance[u]) {
+                    previousNode[v] = (int)u;
+                    queue.push_back(v);
+                }
+            }
+        }
+    }
+    return reached;
+}
+
+} // namespace dsa
+
+#endif
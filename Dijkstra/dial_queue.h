@@ -0,0 +1,72 @@
+#ifndef DIJKSTRA_DIAL_QUEUE_H
+#define DIJKSTRA_DIAL_QUEUE_H
+
+/* =====================================================================
+ * DIAL'S BUCKETS - Dijkstra's queue when the weights are small integers
+ * =====================================================================
+ * One bucket per distance: bucket d holds the vertices at distance d,
+ * and popping is "walk to the next non-empty bucket". No comparisons
+ * at all.
+ *
+ * Only maxWeight + 1 buckets are needed, used as a CIRCLE: everything in
+ * the queue lies in [current, current + maxWeight] (it was pushed as
+ * some popped distance + a weight <= maxWeight, and pops never go back),
+ * so distance d can live in bucket d % (maxWeight + 1) without two
+ * different distances ever sharing a bucket.
+ *
+ *   maxWeight = 3, current = 9:   [ 12 | 9 | 10 | 11 ]   (bucket = d % 4)
+ *                                         ^ current
+ *
+ * Cost: O(m + D) for the whole run, D = the largest distance, since the
+ * cursor passes every distance once. Great for weights up to a few
+ * thousand, bad for 10^9 (D gets huge and so does the bucket array) -
+ * use the radix heap then.
+ *
+ * The keys must be monotone like in the radix heap (never below the
+ * last pop) and at most maxWeight above it.
+ * ===================================================================== */
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace dsa {
+
+template <class V>
+class DialQueue {
+public:
+    explicit DialQueue(uint64_t max_weight) : buckets_(max_weight + 1) {}
+
+    void push(uint64_t key, V value) {
+        assert(key >= current_ && key - current_ < buckets_.size());
+        buckets_[key % buckets_.size()].push_back(value);
+        size_++;
+    }
+
+    // Removes and returns a (key, value) with the smallest key
+    std::pair<uint64_t, V> pop() {
+        size_t b = current_ % buckets_.size();
+        while (buckets_[b].empty()) {  // size_ > 0, so this stops within one lap
+            current_++;
+            if (++b == buckets_.size()) b = 0;
+        }
+        V value = buckets_[b].back();
+        buckets_[b].pop_back();
+        size_--;
+        return {current_, value};  // everything in a bucket has the same key
+    }
+
+    bool empty() const { return size_ == 0; }
+    size_t size() const { return size_; }
+
+private:
+    std::vector<std::vector<V>> buckets_;
+    uint64_t current_ = 0;
+    size_t size_ = 0;
+};
+
+} // namespace dsa
+
+#endif
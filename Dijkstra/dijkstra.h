@@ -0,0 +1,102 @@
+#ifndef DIJKSTRA_DIJKSTRA_H
+#define DIJKSTRA_DIJKSTRA_H
+
+/* =====================================================================
+ * DIJKSTRA over a CSR graph, for any queue engine
+ * =====================================================================
+ * The queue only needs push(dist, node) / pop() -> (dist, node) / empty():
+ *   BinaryHeapQueue    std::priority_queue, lazy deletion (below)
+ *   IndexedDaryHeap    one entry per vertex, decrease_key  (dary_heap.h)
+ *   RadixHeap          monotone integer keys               (radix_heap.h)
+ *   DialQueue          small integer weights               (dial_queue.h)
+ * push() is only called when a distance strictly improves, so for the
+ * indexed heap it is exactly "insert or decrease_key".
+ *
+ * minDistance must come in filled with "infinity", previousNode with -1.
+ *
+ * EARLY STOP: with a target, the search ends the moment the target is
+ * popped - its distance and its whole path are final by then, and
+ * everything still in the queue is farther away. Without one (-1) it
+ * settles everything reachable. Returns how many vertices it settled.
+ *
+ * SAME PATH WITH EVERY QUEUE:
+ * With several shortest paths, previousNode[v] is "whichever optimal
+ * neighbour got settled first", and the queues settle equal distances
+ * in different orders. The binary heap pops (dist, node) pairs, so it
+ * settles the smallest node first - the tie rule below makes every queue
+ * end up with that same neighbour: among the optimal ones, the one with
+ * the smallest distance, then the smallest number. With weight 0 edges
+ * the rule is skipped (the neighbour may be settled already, and
+ * re-pointing it could close a cycle), so there ties may differ.
+ * ===================================================================== */
+
+#include <functional>
+#include <queue>
+#include <utility>
+#include <vector>
+#include "csr_graph.h"
+
+namespace dsa {
+
+// Answer of the point-to-point searches (bidirectional_dijkstra.h, alt.h)
+struct PointToPointResult {
+    long long distance = -1;   // -1 = no path
+    std::vector<int> path;     // source ... target
+    size_t settled = 0;        // vertices settled to find it
+};
+
+// The textbook queue: a binary heap with lazy deletion (outdated entries are skipped when popped)
+struct BinaryHeapQueue {
+    std::priority_queue<std::pair<long long, int>, std::vector<std::pair<long long, int>>,
+                        std::greater<std::pair<long long, int>>> pq;
+
+    void push(long long dist, int node) { pq.push({dist, node}); }
+    std::pair<long long, int> pop() { auto top = pq.top(); pq.pop(); return top; }
+    bool empty() const { return pq.empty(); }
+    size_t size() const { return pq.size(); }
+};
+
+// Graph = CsrGraph or CsrView (a mapped file), anything with begin/end/targets[e]/weights[e]
+template <class Graph, class Queue>
+size_t dijkstra(const Graph& graph, int source, Queue& pq,
+                std::vector<long long>& minDistance, std::vector<int>& previousNode, int target = -1) {
+    size_t settled = 0;
+
+    // From point A to point A of course that the distance is 0
+    minDistance[source] = 0;
+    pq.push(0, source);
+
+    while (!pq.empty()) {
+        auto top = pq.pop();
+        long long currentDist = (long long)top.first;
+        int currentNode = (int)top.second;
+
+        // We can have outdated entries in the priority queue so we ignore them, we store in the minDistance array the best known distance to each node
+        if (currentDist > minDistance[currentNode]) continue;
+
+        settled++;
+        if (currentNode == target) break; // nothing left in the queue can make it shorter
+
+        for (uint32_t e = graph.begin(currentNode); e < graph.end(currentNode); e++) { // Explore all neighbors
+            int neighbor = graph.targets[e];
+            long long edgeWeight = graph.weights[e];
+
+            long long newDistance = minDistance[currentNode] + edgeWeight; // The distance to one of the neighbors might be shorter if we go through the shortest path that passes through the current node
+
+            if (newDistance < minDistance[neighbor]) {
+                minDistance[neighbor] = newDistance;
+                previousNode[neighbor] = currentNode; //Using the previousNode array to rebuild the path later
+                pq.push(newDistance, neighbor);
+            } else if (newDistance == minDistance[neighbor] && edgeWeight > 0 &&
+                       minDistance[previousNode[neighbor]] == minDistance[currentNode] &&
+                       currentNode < previousNode[neighbor]) {
+                previousNode[neighbor] = currentNode; //tie: the neighbour the binary heap would have kept
+            }
+        }
+    }
+    return settled;
+}
+
+} // namespace dsa
+
+#endif
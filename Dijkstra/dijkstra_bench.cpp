@@ -0,0 +1,321 @@
+// Benchmark: Dijkstra queue engines on random graphs, sparse to dense
+// Usage: ./dijkstra_bench [--n N --degree D] [--max-weight W] [--seed S] [--runs R]
+//                         [--grid SIDE] [--road LENGTH] [--pairs K] [--landmarks L]
+//                         [--scale-n N] [--threads T] [--delta D]
+//
+// Without --n it runs a preset from sparse (n = 200000, 8 edges per vertex)
+// to dense (n = 4000, 2000 edges per vertex). Edges are directed, targets
+// uniform, weights uniform in 1..W (default 1000000).
+//
+// For every queue: best time of R runs (the search only, the graph is built
+// once), pushes, and the PEAK number of entries the queue held. The lazy
+// binary heap keeps an entry per improvement, so on dense graphs its peak is
+// many times n; the indexed heaps never hold more than n.
+// All queues must produce the same distances as the first one.
+//
+// Then point-to-point queries on a SIDE x SIDE grid (a road-map stand-in,
+// default 1000, undirected, weights 1..100) between K random pairs
+// (default 20): full search, search that stops at the target, bidirectional
+// search, A* with L landmarks (default 16) picked both ways (alt.h), and
+// a contraction hierarchy query (contraction_hierarchy.h). Average vertices
+// settled and time per query, plus the preprocessing time for the landmarks
+// and the hierarchy (by far the slowest part); all must agree on every
+// distance. The same on a long road (--road LENGTH vertices in a row,
+// default 100000, weights up to 10^6 and a few long detours), whose
+// distances pass 2^32 and need the landmarks' 64-bit tables.
+//
+// Last, thread scaling of delta-stepping (delta_stepping.h): a full
+// single-source tree on a random graph with N vertices (default 2000000,
+// 8 edges per vertex), 1, 2, 4, ... up to T threads (default: every core),
+// bucket width D (default 0 = automatic). Best of R runs against the radix
+// heap Dijkstra; distances and previous nodes must be identical.
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "csr_graph.h"
+#include "dijkstra.h"
+#include "dary_heap.h"
+#include "radix_heap.h"
+#include "dial_queue.h"
+#include "bidirectional_dijkstra.h"
+#include "alt.h"
+#include "contraction_hierarchy.h"
+#include "delta_stepping.h"
+
+using namespace std;
+using ll = long long;
+const ll INF = LLONG_MAX / 4;
+
+// Counts pushes and remembers the largest size the queue ever had
+template <class Q>
+struct Counted : Q {
+    using Q::Q;
+    size_t pushes = 0, peak = 0;
+
+    void push(ll dist, int node) {
+        Q::push(dist, node);
+        pushes++;
+        peak = max(peak, Q::size());
+    }
+};
+
+struct Result {
+    double seconds = 0;
+    size_t pushes = 0, peak = 0;
+    vector<ll> dist;
+};
+
+template <class Q, class... Args>
+static Result run(const dsa::CsrGraph<int>& g, int runs, Args... args) {
+    Result best;
+    for (int r = 0; r < runs; r++) {
+        Counted<Q> pq(args...);
+        vector<ll> dist(g.n, INF);
+        vector<int> prev(g.n, -1);
+        auto start = chrono::steady_clock::now();
+        dsa::dijkstra(g, 0, pq, dist, prev);
+        double s = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        if (r == 0 || s < best.seconds) {
+            best.seconds = s;
+            best.pushes = pq.pushes;
+            best.peak = pq.peak;
+            best.dist = move(dist);
+        }
+    }
+    return best;
+}
+
+static dsa::CsrGraph<int> random_graph(uint32_t n, uint32_t degree, int max_weight, unsigned seed) {
+    mt19937_64 rng(seed);
+    dsa::EdgeList<int> edges;
+    edges.reserve((size_t)n * degree);
+    for (uint32_t u = 0; u < n; u++)
+        for (uint32_t k = 0; k < degree; k++)
+            edges.add(u, (uint32_t)(rng() % n), 1 + (int)(rng() % max_weight));
+    return dsa::build_csr(n, edges, false);
+}
+
+static bool bench(uint32_t n, uint32_t degree, int max_weight, unsigned seed, int runs) {
+    dsa::CsrGraph<int> g = random_graph(n, degree, max_weight, seed);
+    cout << "n " << n << ", " << degree << " edges per vertex (" << g.arcs() << " arcs), weights 1.."
+         << max_weight << "\n";
+
+    vector<pair<string, Result>> results;
+    results.push_back({"binary lazy", run<dsa::BinaryHeapQueue>(g, runs)});
+    results.push_back({"indexed 2-ary", run<dsa::IndexedDaryHeap<ll, 2>>(g, runs, n)});
+    results.push_back({"indexed 4-ary", run<dsa::IndexedDaryHeap<ll, 4>>(g, runs, n)});
+    results.push_back({"indexed 8-ary", run<dsa::IndexedDaryHeap<ll, 8>>(g, runs, n)});
+    results.push_back({"radix", run<dsa::RadixHeap<int>>(g, runs)});
+    if (max_weight <= 1 << 16)
+        results.push_back({"dial", run<dsa::DialQueue<int>>(g, runs, (uint64_t)max_weight)});
+
+    bool ok = true;
+    cout << left << setw(16) << "  queue" << right << setw(10) << "ms" << setw(12) << "pushes"
+         << setw(12) << "peak" << setw(10) << "peak/n" << "\n";
+    for (auto& [name, r] : results) {
+        bool same = r.dist == results[0].second.dist;
+        ok = ok && same;
+        cout << "  " << left << setw(14) << name << right << fixed << setprecision(1)
+             << setw(10) << r.seconds * 1000 << setw(12) << r.pushes << setw(12) << r.peak
+             << setprecision(2) << setw(10) << (double)r.peak / n << (same ? "" : "  DIFFERENT") << "\n";
+    }
+    cout << "\n";
+    return ok;
+}
+
+static dsa::CsrGraph<int> grid_graph(uint32_t side, unsigned seed) {
+    mt19937_64 rng(seed);
+    dsa::EdgeList<int> edges;
+    edges.reserve(2 * (size_t)side * side);
+    for (uint32_t y = 0; y < side; y++)
+        for (uint32_t x = 0; x < side; x++) {
+            uint32_t v = y * side + x;
+            if (x + 1 < side) edges.add(v, v + 1, 1 + (int)(rng() % 100));
+            if (y + 1 < side) edges.add(v, v + side, 1 + (int)(rng() % 100));
+        }
+    return dsa::build_csr(side * side, edges, true);
+}
+
+// A path 0 - 1 - ... - length-1, weights 1..10^6, plus length / 1000 detours
+// between random vertices that cost more than the road between them
+static dsa::CsrGraph<int> road_graph(uint32_t length, unsigned seed) {
+    mt19937_64 rng(seed);
+    dsa::EdgeList<int> edges;
+    for (uint32_t v = 0; v + 1 < length; v++)
+        edges.add(v, v + 1, 1 + (int)(rng() % 1000000));
+    for (uint32_t i = 0; i < length / 1000; i++) {
+        uint32_t a = (uint32_t)(rng() % length), b = (uint32_t)(rng() % length);
+        edges.add(a, b, INT_MAX - (int)(rng() % 1000));
+    }
+    return dsa::build_csr(length, edges, true);
+}
+
+static bool bench_point_to_point(const dsa::CsrGraph<int>& g, const string& title, int pairs, uint32_t landmarks,
+                                 unsigned seed) {
+    mt19937_64 rng(seed + 1);
+    cout << "point to point: " << title << ", " << pairs << " random pairs\n";
+
+    const int MODES = 6;
+    const char* names[MODES] = {"full search", "stop at target", "bidirectional", "ALT farthest", "ALT avoid",
+                                "CH"};
+    double seconds[MODES] = {};
+    size_t settled[MODES] = {};
+    bool ok = true;
+
+    dsa::Landmarks lm[2];
+    for (int i = 0; i < 2; i++) {
+        auto start = chrono::steady_clock::now();
+        lm[i] = dsa::build_landmarks(g, g, landmarks, i == 0 ? dsa::LandmarkMethod::Farthest : dsa::LandmarkMethod::Avoid, seed);
+        cout << "  " << names[3 + i] << ": " << landmarks << " landmarks in " << fixed << setprecision(2)
+             << chrono::duration<double>(chrono::steady_clock::now() - start).count() << " s"
+             << (lm[i].wide ? ", 64-bit tables" : "") << "\n";
+    }
+    dsa::AltSearch<int> alt[2] = {dsa::AltSearch<int>(g, lm[0]), dsa::AltSearch<int>(g, lm[1])};
+
+    auto chStart = chrono::steady_clock::now();
+    dsa::ContractionHierarchy ch = dsa::build_contraction_hierarchy(g);
+    cout << "  " << names[5] << ": " << ch.shortcuts() << " shortcuts in " << fixed << setprecision(2)
+         << chrono::duration<double>(chrono::steady_clock::now() - chStart).count() << " s\n";
+    dsa::ChSearch chSearch(ch);
+
+    for (int q = 0; q < pairs; q++) {
+        int s = (int)(rng() % g.n), t = (int)(rng() % g.n);
+        ll d[MODES];
+        for (int mode = 0; mode < MODES; mode++) {
+            auto start = chrono::steady_clock::now();
+            if (mode == 5) {
+                dsa::PointToPointResult r = chSearch.query(s, t);
+                settled[mode] += r.settled;
+                d[mode] = r.distance;
+            } else if (mode >= 3) {
+                dsa::PointToPointResult r = alt[mode - 3].query(s, t);
+                settled[mode] += r.settled;
+                d[mode] = r.distance;
+            } else if (mode < 2) {
+                dsa::RadixHeap<int> pq;
+                vector<ll> dist(g.n, INF);
+                vector<int> prev(g.n, -1);
+                settled[mode] += dsa::dijkstra(g, s, pq, dist, prev, mode == 0 ? -1 : t);
+                d[mode] = dist[t];
+            } else {
+                dsa::PointToPointResult r = dsa::bidirectional_dijkstra(g, g, s, t);
+                settled[mode] += r.settled;
+                d[mode] = r.distance;
+            }
+            seconds[mode] += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        }
+        for (int mode = 1; mode < MODES; mode++)
+            ok = ok && d[mode] == d[0];
+    }
+
+    cout << left << setw(18) << "  search" << right << setw(14) << "settled" << setw(10) << "% of n"
+         << setw(10) << "ms" << "\n";
+    for (int mode = 0; mode < MODES; mode++)
+        cout << "  " << left << setw(16) << names[mode] << right << fixed << setprecision(0)
+             << setw(14) << (double)settled[mode] / pairs << setprecision(1)
+             << setw(10) << 100.0 * settled[mode] / pairs / g.n
+             << setprecision(3) << setw(10) << seconds[mode] * 1000 / pairs << "\n";
+    if (!ok)
+        cout << "  DIFFERENT distances\n";
+    cout << "\n";
+    return ok;
+}
+
+static bool bench_scaling(uint32_t n, uint32_t degree, int max_weight, unsigned seed, int runs,
+                          unsigned max_threads, long long delta) {
+    dsa::CsrGraph<int> g = random_graph(n, degree, max_weight, seed);
+    cout << "delta-stepping: n " << n << ", " << degree << " edges per vertex, weights 1.." << max_weight << "\n";
+
+    vector<ll> dist(g.n, INF);
+    vector<int> prev(g.n, -1);
+    double dijkstraSeconds = 0;
+    for (int r = 0; r < runs; r++) {
+        fill(dist.begin(), dist.end(), INF);
+        fill(prev.begin(), prev.end(), -1);
+        dsa::RadixHeap<int> pq;
+        auto start = chrono::steady_clock::now();
+        dsa::dijkstra(g, 0, pq, dist, prev);
+        double sec = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        dijkstraSeconds = r == 0 ? sec : min(dijkstraSeconds, sec);
+    }
+    cout << left << setw(18) << "  threads" << right << setw(10) << "ms" << setw(10) << "speedup" << "\n";
+    cout << "  " << left << setw(16) << "dijkstra" << right << fixed << setprecision(1)
+         << setw(10) << dijkstraSeconds * 1000 << setprecision(2) << setw(10) << 1.0 << "\n";
+
+    bool ok = true;
+    vector<unsigned> counts;
+    for (unsigned t = 1; t < max_threads; t *= 2)
+        counts.push_back(t);
+    counts.push_back(max_threads);
+    for (unsigned t : counts) {
+        double best = 0;
+        bool same = true;
+        for (int r = 0; r < runs; r++) {
+            vector<ll> d(g.n, INF);
+            vector<int> p(g.n, -1);
+            auto start = chrono::steady_clock::now();
+            dsa::delta_stepping(g, 0, d, p, delta, t);
+            double sec = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            best = r == 0 ? sec : min(best, sec);
+            same = same && d == dist && p == prev;
+        }
+        ok = ok && same;
+        cout << "  " << left << setw(16) << t << right << fixed << setprecision(1) << setw(10) << best * 1000
+             << setprecision(2) << setw(10) << dijkstraSeconds / best << (same ? "" : "  DIFFERENT") << "\n";
+    }
+    cout << "\n";
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    uint32_t n = 0, degree = 16, side = 1000, road = 100000;
+    int pairs = 20;
+    uint32_t landmarks = 16;
+    int max_weight = 1000000, runs = 3;
+    unsigned seed = 1;
+    uint32_t scaleN = 2000000;
+    unsigned threads = max(1u, thread::hardware_concurrency());
+    long long delta = 0;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--n") == 0) n = (uint32_t)atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--degree") == 0) degree = (uint32_t)atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--max-weight") == 0) max_weight = max(1, atoi(argv[i + 1]));
+        else if (strcmp(argv[i], "--seed") == 0) seed = (unsigned)atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--runs") == 0) runs = max(1, atoi(argv[i + 1]));
+        else if (strcmp(argv[i], "--grid") == 0) side = (uint32_t)max(2, atoi(argv[i + 1]));
+        else if (strcmp(argv[i], "--road") == 0) road = (uint32_t)max(2, atoi(argv[i + 1]));
+        else if (strcmp(argv[i], "--pairs") == 0) pairs = max(1, atoi(argv[i + 1]));
+        else if (strcmp(argv[i], "--landmarks") == 0) landmarks = (uint32_t)max(1, atoi(argv[i + 1]));
+        else if (strcmp(argv[i], "--scale-n") == 0) scaleN = (uint32_t)max(1, atoi(argv[i + 1]));
+        else if (strcmp(argv[i], "--threads") == 0) threads = (unsigned)max(1, atoi(argv[i + 1]));
+        else if (strcmp(argv[i], "--delta") == 0) delta = atoll(argv[i + 1]);
+        else {
+            cerr << "unknown option " << argv[i] << " (see the top of dijkstra_bench.cpp)\n";
+            return 1;
+        }
+    }
+
+    bool ok = true;
+    if (n > 0) {
+        ok = bench(n, degree, max_weight, seed, runs);
+    } else {
+        ok = bench(200000, 8, max_weight, seed, runs) && ok;
+        ok = bench(50000, 100, max_weight, seed, runs) && ok;
+        ok = bench(10000, 1000, max_weight, seed, runs) && ok;
+        ok = bench(4000, 2000, max_weight, seed, runs) && ok;
+    }
+    ok = bench_point_to_point(grid_graph(side, seed), to_string(side) + " x " + to_string(side) + " grid", pairs,
+                              landmarks, seed) && ok;
+    ok = bench_point_to_point(road_graph(road, seed), "road of " + to_string(road), pairs, landmarks, seed) && ok;
+    ok = bench_scaling(scaleN, 8, max_weight, seed, runs, threads, delta) && ok;
+    return ok ? 0 : 1;
+}
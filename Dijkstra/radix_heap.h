@@ -0,0 +1,107 @@
+#ifndef DIJKSTRA_RADIX_HEAP_H
+#define DIJKSTRA_RADIX_HEAP_H
+
+/* =====================================================================
+ * RADIX HEAP - a priority queue for MONOTONE integer keys
+ * =====================================================================
+ * Dijkstra never pushes a key smaller than the one it just popped
+ * (distance + non-negative weight). A radix heap only works under that
+ * promise, and uses it to avoid comparisons almost entirely.
+ *
+ * IDEA: remember last = the last key popped. Put every key x in bucket
+ *   b(x) = position of the highest bit where x and last differ (1..64),
+ *          0 if x == last
+ *
+ *   last = 0b101000
+ *   x    = 0b101000 -> bucket 0   (equal)
+ *   x    = 0b101011 -> bucket 2   (differs first at bit 1)
+ *   x    = 0b110000 -> bucket 5   (differs first at bit 4)
+ *
+ * Every key in bucket i is smaller than every key in bucket i + 1, so
+ * the minimum is in the lowest non-empty bucket.
+ *
+ * POP: if bucket 0 has something, that is a minimum, done. Otherwise
+ * take the lowest non-empty bucket i, find its minimum m, set last = m
+ * and redistribute bucket i: all its keys share the bits above i with
+ * m, so each lands in a bucket BELOW i. A key only ever moves down,
+ * at most 64 times in total, so a push + pop is O(log C) amortized
+ * (C = the largest key difference) with one cheap scan per move instead
+ * of a heap's sift with log(n) unpredictable comparisons.
+ *
+ * Ties come out in no particular order (bucket 0 is a stack).
+ * ===================================================================== */
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace dsa {
+
+template <class V>
+class RadixHeap {
+public:
+    void push(uint64_t key, V value) {
+        assert(key >= last_ && "radix heap keys must never go below the last pop");
+        buckets_[bucket_of(key)].emplace_back(key, value);
+        size_++;
+    }
+
+    // Removes and returns a (key, value) with the smallest key
+    std::pair<uint64_t, V> pop() {
+        if (buckets_[0].empty())
+            refill();
+        std::pair<uint64_t, V> top = buckets_[0].back();
+        buckets_[0].pop_back();
+        size_--;
+        return top;
+    }
+
+    // Smallest key without removing it (may move a bucket down, hence not const)
+    uint64_t top_key() {
+        if (buckets_[0].empty())
+            refill();
+        return last_;
+    }
+
+    bool empty() const { return size_ == 0; }
+    size_t size() const { return size_; }
+
+    // Empty again, ready for keys from 0 (buckets keep their memory)
+    void clear() {
+        for (auto& bucket : buckets_)
+            bucket.clear();
+        last_ = 0;
+        size_ = 0;
+    }
+
+private:
+    std::vector<std::pair<uint64_t, V>> buckets_[65];
+    uint64_t last_ = 0;
+    size_t size_ = 0;
+
+    int bucket_of(uint64_t key) const {
+        return key == last_ ? 0 : 64 - __builtin_clzll(key ^ last_);
+    }
+
+    // Moves the lowest non-empty bucket down around its minimum
+    void refill() {
+        int i = 1;
+        while (buckets_[i].empty())
+            i++;
+
+        uint64_t m = buckets_[i][0].first;
+        for (const auto& e : buckets_[i])
+            if (e.first < m) m = e.first;
+        last_ = m;
+
+        for (const auto& e : buckets_[i])
+            buckets_[bucket_of(e.first)].push_back(e);  // always a bucket < i
+        buckets_[i].clear();  // keeps its capacity for the next round
+    }
+};
+
+} // namespace dsa
+
+#endif
@@ -0,0 +1,241 @@
+#ifndef DSA_SOURCE_CODE_FAST_IO_H
+#define DSA_SOURCE_CODE_FAST_IO_H
+
+/* =====================================================================
+ * FAST INPUT / OUTPUT shared by all programs in this repo
+ * =====================================================================
+ *
+ * Even with ios::sync_with_stdio(false), cin >> string does a lot of work
+ * per token: locale checks, one character at a time, and a std::string
+ * (often a malloc) for every name. On 10^7 commands that is most of the
+ * runtime.
+ *
+ * FastReader:
+ *   - Gets the WHOLE input into memory once:
+ *       regular file -> mmap() it (the OS maps the page cache, no copy)
+ *       pipe/terminal -> read() it in big blocks
+ *   - Finds token boundaries 16 bytes at a time with SSE2 (any byte <= ' '
+ *     is whitespace), plain loop on other CPUs
+ *   - readToken() returns a string_view that points INTO the input buffer
+ *     (no copy, valid as long as the reader lives)
+ *
+ * FastWriter:
+ *   - Collects output in a 64 KB buffer and write()s it in big chunks
+ *   - Flushes on destruction, so just let it go out of scope at the end
+ *
+ * Usage:
+ *   FastReader in;             // stdin
+ *   FastWriter out;            // stdout
+ *   int t = in.readInt();
+ *   string_view name = in.readToken();
+ *   out.write(name); out.put('\n');
+ * ===================================================================== */
+
+#include <string_view>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+class FastReader {
+public:
+    explicit FastReader(int fd = 0) { load(fd); }
+
+    explicit FastReader(const char* path) {
+        int fd = open(path, O_RDONLY);
+        if (fd >= 0) {
+            load(fd);
+            close(fd);
+        }
+    }
+
+    ~FastReader() {
+        if (mapped)
+            munmap(data, size);
+        else
+            free(data);
+        if (scratch != inlineScratch)
+            free(scratch);
+    }
+
+    FastReader(const FastReader&) = delete;
+    FastReader& operator=(const FastReader&) = delete;
+
+    // false when only whitespace is left
+    bool hasMore() {
+        skipSpaces();
+        return pos < size;
+    }
+
+    // Next whitespace separated token as a view into the input (empty at EOF)
+    std::string_view readToken() {
+        skipSpaces();
+        size_t start = pos;
+        pos = findSpace(pos);
+        return std::string_view(data + start, pos - start);
+    }
+
+    // Same token, copied with a '\0' for C APIs; valid until the next call
+    const char* readCString() {
+        std::string_view token = readToken();
+        if (token.size() >= scratchSize) {
+            scratchSize = token.size() * 2 + 1;
+            scratch = (char*)realloc(scratch == inlineScratch ? nullptr : scratch, scratchSize);
+        }
+        memcpy(scratch, token.data(), token.size());
+        scratch[token.size()] = '\0';
+        return scratch;
+    }
+
+    long long readInt() {
+        skipSpaces();
+        bool negative = false;
+        if (pos < size && (data[pos] == '-' || data[pos] == '+'))
+            negative = data[pos++] == '-';
+
+        unsigned long long value = 0;
+        while (pos < size && (unsigned char)(data[pos] - '0') < 10)
+            value = value * 10 + (data[pos++] - '0');
+        return negative ? -(long long)value : (long long)value;
+    }
+
+    // The whole input, for callers that want to scan it themselves
+    std::string_view buffer() const { return std::string_view(data, size); }
+
+private:
+    char* data = nullptr;
+    size_t size = 0;
+    size_t pos = 0;
+    bool mapped = false;
+    char inlineScratch[64];
+    char* scratch = inlineScratch;
+    size_t scratchSize = sizeof(inlineScratch);
+
+    void load(int fd) {
+        struct stat st;
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+            void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                data = (char*)p;
+                size = st.st_size;
+                mapped = true;
+#ifdef MADV_SEQUENTIAL
+                madvise(p, size, MADV_SEQUENTIAL);  // we read front to back once
+#endif
+                return;
+            }
+        }
+
+        // Not a file (pipe, terminal): read everything in 1 MB+ blocks
+        size_t capacity = 1 << 20;
+        data = (char*)malloc(capacity);
+        while (true) {
+            if (size == capacity) {
+                capacity *= 2;
+                data = (char*)realloc(data, capacity);
+            }
+            ssize_t got = read(fd, data + size, capacity - size);
+            if (got <= 0)
+                break;
+            size += got;
+        }
+    }
+
+    static bool isSpace(char c) { return (unsigned char)c <= ' '; }
+
+    void skipSpaces() {
+        while (pos < size && isSpace(data[pos]))
+            ++pos;
+    }
+
+    // First whitespace byte at or after i (size if none)
+    size_t findSpace(size_t i) const {
+#ifdef __SSE2__
+        // bytes <= ' ' (unsigned): max(b, ' ') == ' '
+        const __m128i space = _mm_set1_epi8(' ');
+        while (i + 16 <= size) {
+            __m128i chunk = _mm_loadu_si128((const __m128i*)(data + i));
+            unsigned mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(chunk, space), space));
+            if (mask)
+                return i + __builtin_ctz(mask);
+            i += 16;
+        }
+#endif
+        while (i < size && !isSpace(data[i]))
+            ++i;
+        return i;
+    }
+};
+
+class FastWriter {
+public:
+    explicit FastWriter(int fd = 1) : fd(fd) {}
+    ~FastWriter() { flush(); }
+
+    FastWriter(const FastWriter&) = delete;
+    FastWriter& operator=(const FastWriter&) = delete;
+
+    void put(char c) {
+        if (used == sizeof(buf))
+            flush();
+        buf[used++] = c;
+    }
+
+    void write(std::string_view s) {
+        if (s.size() > sizeof(buf) - used) {
+            flush();
+            if (s.size() > sizeof(buf)) {  // too big to buffer, send it directly
+                writeAll(s.data(), s.size());
+                return;
+            }
+        }
+        memcpy(buf + used, s.data(), s.size());
+        used += s.size();
+    }
+
+    void writeInt(long long x) {
+        char digits[24];
+        int n = 0;
+        unsigned long long u = x < 0 ? 0ULL - (unsigned long long)x : (unsigned long long)x;
+        do {
+            digits[n++] = char('0' + u % 10);
+            u /= 10;
+        } while (u);
+        if (x < 0)
+            digits[n++] = '-';
+
+        if (sizeof(buf) - used < (size_t)n)
+            flush();
+        while (n)
+            buf[used++] = digits[--n];
+    }
+
+    void flush() {
+        writeAll(buf, used);
+        used = 0;
+    }
+
+private:
+    int fd;
+    size_t used = 0;
+    char buf[1 << 16];
+
+    void writeAll(const char* p, size_t n) {
+        while (n > 0) {
+            ssize_t done = ::write(fd, p, n);
+            if (done <= 0)
+                return;
+            p += done;
+            n -= done;
+        }
+    }
+};
+
+#endif
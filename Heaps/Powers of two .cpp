@@ -5,17 +5,17 @@
 #include <iostream>
 #include <string>
 #include <queue>
+#include "../FastIO/fast_io.h"
 //again i don't have bits/stdc++.h on MacOs
 
 using namespace std;
 
 int main() {
-    ios::sync_with_stdio(false); //SPEED!!!
-    cin.tie(nullptr);
+    FastReader in; //SPEED!!!
+    FastWriter out;
 
-    long long n;
-    int k;
-    cin >> n >> k;
+    long long n = in.readInt();
+    int k = in.readInt();
 
     //Store bits
     priority_queue<int> pq;
@@ -26,7 +26,7 @@ int main() {
 
     //Too many bits
     if ((int)pq.size() > k) {
-        cout << "NO\n";
+        out.write("NO\n");
         return 0;
     }
 
@@ -36,7 +36,7 @@ int main() {
         pq.pop();
 
         if (largest == 1) {
-            cout << "NO\n";
+            out.write("NO\n");
             return 0;
         }
 
@@ -44,12 +44,13 @@ int main() {
         pq.push(largest / 2);
     }
 
-    cout << "YES\n";
+    out.write("YES\n");
     while (!pq.empty()) {
-        cout << pq.top() << " ";
+        out.writeInt(pq.top());
+        out.put(' ');
         pq.pop();
     }
-    cout << "\n";
+    out.put('\n');
 
     return 0;
 }
\ No newline at end of file
@@ -1,4 +1,4 @@
-#include "/Users/killity/Documents/DSA_Source_Code/Heaps/Powers-Of-Two-C-implementation/heap.h"
+#include "heap.h"
 
 // Restore heap property for subtree rooted at index i
 void heapify(Heap *h, int i) {
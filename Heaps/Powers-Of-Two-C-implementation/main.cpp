@@ -1,5 +1,6 @@
 #include <iostream>
-#include "/Users/killity/Documents/DSA_Source_Code/Heaps/Powers-Of-Two-C-implementation/heap.h"
+#include "heap.h"
+#include "../../FastIO/fast_io.h"
 using namespace std;
 
 // Problem link: https://codeforces.com/problemset/problem/1095/C
@@ -9,12 +10,11 @@ using namespace std;
 // works on example cases can't test because it is made using multiple files
 
 int main() {
-    ios::sync_with_stdio(false);
-    cin.tie(nullptr);
+    FastReader in;
+    FastWriter out;
 
-    long long n;
-    int k;
-    cin >> n >> k;
+    long long n = in.readInt();
+    int k = in.readInt();
 
     Heap pq;
     heap_init(&pq);
@@ -25,7 +25,7 @@ int main() {
     }
 
     if (heap_size(&pq) > k) {
-        cout << "NO\n";
+        out.write("NO\n");
         return 0;
     }
 
@@ -34,7 +34,7 @@ int main() {
         heap_pop(&pq);
 
         if (largest == 1) {
-            cout << "NO\n";
+            out.write("NO\n");
             return 0;
         }
 
@@ -42,12 +42,13 @@ int main() {
         heap_push(&pq, largest / 2);
     }
 
-    cout << "YES\n";
+    out.write("YES\n");
     while (heap_size(&pq) > 0) {
-        cout << heap_top(&pq) << " ";
+        out.writeInt(heap_top(&pq));
+        out.put(' ');
         heap_pop(&pq);
     }
-    cout << "\n";
+    out.put('\n');
 
     return 0;
 }
\ No newline at end of file